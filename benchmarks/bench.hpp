@@ -0,0 +1,51 @@
+/// @file bench.hpp
+/// Minimal helpers shared by the benchmarks
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+static inline uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+}
+
+/// Sink for results so the loops are not optimized out
+static volatile uint32_t sink { 0 };
+
+/// First command line argument as iteration count
+static inline unsigned long iterations(int argc, char **argv, unsigned long defaultValue)
+{
+    if (argc > 1)
+        return strtoul(argv[1], nullptr, 10);
+    return defaultValue;
+}
+
+/// One JSON object per line, optional counter is reported per op
+static inline void report(const char *name,
+                          unsigned actors,
+                          unsigned long ops,
+                          uint64_t ns,
+                          const char *counterName = nullptr,
+                          unsigned long long counter = 0)
+{
+    printf("{\"bench\":\"%s\",\"actors\":%u,\"ops\":%lu,\"ns_total\":%llu,\"ns_per_op\":%.2f",
+           name,
+           actors,
+           ops,
+           (unsigned long long) ns,
+           ops ? double(ns) / double(ops) : 0.0);
+    if (counterName)
+        printf(",\"%s_per_op\":%.2f", counterName, ops ? double(counter) / double(ops) : 0.0);
+    printf("}\n");
+}
+
+} // namespace bench
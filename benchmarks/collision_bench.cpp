@@ -0,0 +1,40 @@
+/// @file collision_bench.cpp
+/// Collision system with every actor being a collider
+
+#include "rowguelike.hpp"
+
+#include "bench.hpp"
+
+using namespace rwe;
+
+static unsigned long long colliderCalls { 0 };
+
+int main(int argc, char **argv)
+{
+    const auto n = bench::iterations(argc, argv, 2000);
+
+    srand(1);
+    RWE.reset();
+    for (int i = 0; i < Setup::Actors; i++)
+        RWE.make()
+            .randomPosition()
+            .collider(1, COLLIDER_FN {
+                colliderCalls++;
+                if (TEST_HIT)
+                    bench::sink = bench::sink + 1;
+            })
+            .spawn();
+
+    const auto t0 = bench::nowNs();
+    for (unsigned long i = 0; i < n; i++)
+        RWE.collisionSystem();
+
+    bench::report(Setup::CollisionBroadphase ? "collision_broadphase" : "collision_all_pairs",
+                  Setup::Actors,
+                  n,
+                  bench::nowNs() - t0,
+                  "callbacks",
+                  colliderCalls);
+
+    return 0;
+}
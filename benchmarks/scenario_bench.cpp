@@ -0,0 +1,134 @@
+/// @file scenario_bench.cpp
+/// Runs one of the example games headless with scripted input
+/// Built with RW_SETUP_PROFILE, system timings come from Engine::profile
+/// Scenario is selected with RW_BENCH_<NAME>, first argument is the frame count
+/// NB: the scene is filled with wandering actors up to RW_BENCH_FILL percent of RW_SETUP_ACTORS,
+/// so the 64 and 255 actor runs differ in workload, not only in capacity
+
+#if defined(RW_BENCH_SNAKE)
+#include "snake/snake.hpp"
+#define RW_BENCH_NAME "snake"
+#define RW_BENCH_SETUP setupExampleSnake
+#elif defined(RW_BENCH_PONG)
+#include "pong/pong.hpp"
+#define RW_BENCH_NAME "pong"
+#define RW_BENCH_SETUP setupPong
+#elif defined(RW_BENCH_BIRDS)
+#include "birds/birds.hpp"
+#define RW_BENCH_NAME "birds"
+#define RW_BENCH_SETUP setupBirds
+#elif defined(RW_BENCH_PIXEL_ARCADE)
+#include "pixel_arcade/pixel_arcade.hpp"
+#define RW_BENCH_NAME "pixel_arcade"
+#define RW_BENCH_SETUP setupPixelArcade
+#elif defined(RW_BENCH_DEMO3D)
+#include "demo3d/demo3d.hpp"
+#define RW_BENCH_NAME "demo3d"
+#define RW_BENCH_SETUP setupDemo3D
+#else
+#error "no scenario selected"
+#endif
+
+#include "bench.hpp"
+
+#ifndef RW_BENCH_FILL
+#define RW_BENCH_FILL 75
+#endif
+
+using namespace rwe;
+
+/// Tag group of the filler actors, the scenarios use none
+static constexpr Engine::Group FillerGroup { Setup::TagGroups - 1 };
+
+/// Filler for the free slots after setup, the rest of the slots stay free for the game
+static uint16_t fillerCount()
+{
+    uint16_t active = 0;
+    for (uint16_t i = 0; i < Setup::Actors; i++)
+        active += RWE.isActiveActor(i);
+
+    const uint16_t target = uint32_t(Setup::Actors) * RW_BENCH_FILL / 100;
+    return active < target ? target - active : 0;
+}
+
+/// Moving text actors turning around on a timer, spawned again when a game resets the engine
+static void spawnFiller(uint16_t count)
+{
+    for (uint16_t i = RWE.groupCount(FillerGroup); i < count; i++) {
+        const auto id = RWE.make(Actor::Move | Actor::Text)
+                            .randomPosition()
+                            .speed(i % 2 ? 1 : -1, 0)
+                            .text(".")
+                            .timer(4 + i % 8, TIMER_FN {
+                                auto &s = RWE.getSpeed(receiver);
+                                s.vx = -s.vx;
+                            })
+                            .group(FillerGroup)
+                            .spawn();
+        if (!id.has_value())
+            break;
+    }
+}
+
+/// Scripted input: a key every other frame, SELECT regularly
+static RawControlState scriptedInput(unsigned long frame)
+{
+    RawControlState ret;
+    switch (frame % 16) {
+    case 1: ret.right = true; break;
+    case 3: ret.down = true; break;
+    case 5: ret.select = true; break;
+    case 7: ret.left = true; break;
+    case 9: ret.up = true; break;
+    case 13: ret.select = true; break;
+    }
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const auto frames = bench::iterations(argc, argv, 100000);
+
+    // headless frontend with custom characters, peers stay no-ops
+    static int headless;
+    RWE.drawContext.ctx = &headless;
+    RWE.drawContext.customCharacters = 8;
+
+    srand(1);
+    RW_BENCH_SETUP();
+    const auto filler = fillerCount();
+    spawnFiller(filler);
+    RWE.profile.reset();
+
+    const auto t0 = bench::nowNs();
+    for (unsigned long i = 0; i < frames; i++) {
+        if (RWE.groupCount(FillerGroup) < filler)
+            spawnFiller(filler);
+        RWE.rawInput = scriptedInput(i);
+        RWE.runLoop();
+    }
+    const auto ns = bench::nowNs() - t0;
+
+    const auto &p = RWE.profile;
+    const double perFrame = p.frames ? 1.0 / p.frames : 0.0;
+    const double nsPerTick = 1e9 / p.ticksPerSecond;
+
+    printf("{\"scenario\":\"%s\",\"actors\":%u,\"filler\":%u,\"frames\":%lu,\"ns_per_frame\":%.2f,\"fps\":%.1f,"
+           "\"systems_ns_per_frame\":{",
+           RW_BENCH_NAME,
+           unsigned(Setup::Actors),
+           unsigned(filler),
+           frames,
+           frames ? double(ns) / frames : 0.0,
+           ns ? frames * 1e9 / double(ns) : 0.0);
+    for (int s = 0; s < Profile::SystemCount; s++)
+        printf("%s\"%s\":%.2f", s ? "," : "", Profile::systemName(s), p.total.ticks[s] * nsPerTick * perFrame);
+    printf("},\"actors_visited_per_frame\":%.2f,\"collider_calls_per_frame\":%.2f,"
+           "\"texts_drawn_per_frame\":%.2f,\"peer_calls_per_frame\":%.2f}\n",
+           p.total.actorsVisited * perFrame,
+           p.total.colliderCalls * perFrame,
+           p.total.textsDrawn * perFrame,
+           p.total.peerCalls * perFrame);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/// @file spawn_bench.cpp
+/// Spawn / remove churn on a half-filled actor table, iteration before / after compact()
+
+#include "rowguelike.hpp"
+
+#include "bench.hpp"
+
+using namespace rwe;
+
+/// Previous allocator: two linear scans over the actor table per spawn
+static bool legacySpawn()
+{
+    bool any = false;
+    for (int i = 0; i < Setup::Actors; i++)
+        if (!RWE.isActiveActor(i)) {
+            any = true;
+            break;
+        }
+    if (!any)
+        return false;
+
+    for (int i = 0; i < Setup::Actors; i++)
+        if (!RWE.isActiveActor(i)) {
+            bench::sink = bench::sink + i;
+            return true;
+        }
+    return false;
+}
+
+static void fillHalf()
+{
+    RWE.reset();
+    for (int i = 0; i < Setup::Actors / 2; i++)
+        RWE.make(Actor::Move).spawn();
+}
+
+int main(int argc, char **argv)
+{
+    const auto n = bench::iterations(argc, argv, 1000000);
+
+    // spawn one, remove a pseudo-random live one
+    fillHalf();
+    auto t0 = bench::nowNs();
+    uint32_t seed = 1;
+    for (unsigned long i = 0; i < n; i++) {
+        auto id = RWE.make(Actor::Move).spawn();
+        if (id.has_value())
+            bench::sink = bench::sink + id.value();
+
+        seed = seed * 1103515245u + 12345u;
+        RWE.remove(EntityId((seed >> 16) % Setup::Actors));
+    }
+    bench::report("spawn_remove", Setup::Actors, n, bench::nowNs() - t0);
+
+    // free id lookup only
+    fillHalf();
+    t0 = bench::nowNs();
+    for (unsigned long i = 0; i < n; i++) {
+        if (RWE.canSpawn()) {
+            auto id = RWE.getFreeEntityId();
+            bench::sink = bench::sink + id.value();
+        }
+    }
+    bench::report("free_id_lookup", Setup::Actors, n, bench::nowNs() - t0);
+
+    fillHalf();
+    t0 = bench::nowNs();
+    for (unsigned long i = 0; i < n; i++)
+        legacySpawn();
+    bench::report("free_id_lookup_linear", Setup::Actors, n, bench::nowNs() - t0);
+
+    // a quarter of the table left live at scattered ids
+    RWE.reset();
+    for (int i = 0; i < Setup::Actors; i++)
+        RWE.make(Actor::Move).speed(0, 0).spawn();
+    seed = 1;
+    for (int i = 0; i < Setup::Actors; i++) {
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 4)
+            RWE.remove(EntityId(i));
+    }
+    t0 = bench::nowNs();
+    for (unsigned long i = 0; i < n; i++)
+        RWE.movementSystem();
+    bench::report("movement_scattered", Setup::Actors, n, bench::nowNs() - t0, "active_end", RWE.activeEnd() * n);
+
+    RWE.compact();
+    t0 = bench::nowNs();
+    for (unsigned long i = 0; i < n; i++)
+        RWE.movementSystem();
+    bench::report("movement_compacted", Setup::Actors, n, bench::nowNs() - t0, "active_end", RWE.activeEnd() * n);
+
+    return 0;
+}
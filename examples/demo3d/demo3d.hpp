@@ -3,7 +3,9 @@
 
 #pragma once
 
+#ifndef RW_SETUP_ACTORS
 #define RW_SETUP_ACTORS 4 // reduce memory usage
+#endif
 #define RW_SETUP_WITH_3D true
 
 #include "rowguelike.hpp"
@@ -11,13 +11,43 @@ using namespace rwe ;
 constexpr int8_t SCREEN_WIDTH = Setup::ScreenWidth;
 constexpr int8_t SCREEN_HEIGHT = Setup::ScreenHeight;
 
+// Collision layers: bullets and enemies only test against each other
+constexpr uint8_t LAYER_BULLET = 1;
+constexpr uint8_t LAYER_ENEMY = 2;
+
 // === Forward declarations ===
 void SpawnEnemy();
 void ShootBullet(const EntityId &receiver, const RawControlState &input);
+void BulletCollider(const EntityId &receiver, const EntityId peer);
+void BulletTimer(const EntityId &receiver);
+void EnemyCollider(const EntityId &receiver, const EntityId peer);
+void EnemyTimer(const EntityId &receiver);
+void setupHorizontalSpace();
+
+// === Prefabs, registered once in setupHorizontalSpace() ===
+enum : Engine::Prefab { PREFAB_BULLET, PREFAB_ENEMY };
+
+// Bullet going to the right
+constexpr SceneActor bulletPrefab RW_PROGMEM = SceneActor() //
+    .text("-")
+    .speed(1, 0) // move right
+    .collider(2, BulletCollider, LAYER_BULLET, 1 << LAYER_ENEMY)
+    .timer(1, BulletTimer);
+
+// Enemy moving left
+constexpr SceneActor enemyPrefab RW_PROGMEM = SceneActor() //
+    .text("@")
+    .position(SCREEN_WIDTH - 1, 0)
+    .speed(-1, 0) // move left
+    .collider(1, EnemyCollider, LAYER_ENEMY, 1 << LAYER_BULLET)
+    .timer(1, EnemyTimer);
 
 // === Setup Entry Point ===
 void setupHorizontalSpace()
 {
+    RWE.setPrefab(PREFAB_BULLET, &bulletPrefab);
+    RWE.setPrefab(PREFAB_ENEMY, &enemyPrefab);
+
     // Background
     A::Background().spawn();
 
@@ -35,35 +65,65 @@ void setupHorizontalSpace()
         .spawn();
 }
 
+// === Bullet and enemy callbacks ===
+void BulletCollider(const EntityId &receiver, const EntityId peer)
+{
+    if (TEST_HIT) {
+        RWE.remove(receiver); // destroy bullet
+        RWE.remove(peer);     // destroy enemy
+    }
+}
+
+void BulletTimer(const EntityId &receiver)
+{
+    // Cleanup off-screen bullet
+    auto &p = RWE.getPosition(receiver);
+    if (p.x >= (SCREEN_WIDTH - 1))
+        RWE.remove(receiver);
+}
+
+void EnemyCollider(const EntityId &receiver, const EntityId peer)
+{
+    if (TEST_HIT) {
+        RWE.remove(receiver); // destroy enemy
+        RWE.remove(peer);     // destroy bullet
+    }
+}
+
+void EnemyTimer(const EntityId &receiver)
+{
+    // Despawn if off screen
+    auto &p = RWE.getPosition(receiver);
+    if (p.x < 1) {
+        RWE.remove(receiver);
+
+        //
+        RWE.reset(); // = Engine();
+
+        RWE.make() //
+            .text("   Game Over    ", "                ")
+            .timer(
+                20,
+                TIMER_FN {
+                    RWE.reset(); // = Engine();
+                    setupHorizontalSpace();
+                })
+            .spawn();
+    }
+}
+
 // === Input handler for player shooting ===
 void ShootBullet(const EntityId &receiver, const RawControlState &input)
 {
     if (!input.select) return;
 
-    const auto &pos = RWE.getPosition(receiver);
-
-    // Spawn a bullet going to the right
-    RWE.make()
-        .text("-")
-        .position(pos.x + 1, pos.y)
-        .speed(1, 0) // move right
-        .collider(
-            2,
-            COLLIDER_FN {
-                if (TEST_HIT) {
-                    RWE.remove(receiver); // destroy bullet
-                    RWE.remove(peer);     // destroy enemy
-                }
-            })
-        .timer(
-            1,
-            TIMER_FN {
-                // Cleanup off-screen bullet
-                auto &p = RWE.getPosition(receiver);
-                if (p.x >= (SCREEN_WIDTH - 1))
-                    RWE.remove(receiver);
-            })
-        .spawn();
+    // Spawn a bullet in front of the player
+    const EntityId shooter = receiver;
+    RWE.spawnMany(PREFAB_BULLET, 1, [shooter](uint16_t, Components::Position &p) {
+        const auto &pos = RWE.getPosition(shooter);
+        p.x = pos.x + 1;
+        p.y = pos.y;
+    });
 }
 
 // === Spawns an enemy moving left on a random row ===
@@ -72,41 +132,6 @@ void SpawnEnemy()
     // Alternate rows to simulate random pattern
     static bool toggle = false;
     toggle = !toggle;
-    int8_t y = toggle ? 0 : 1;
-
-    RWE.make()
-        .text("@")
-        .position(SCREEN_WIDTH - 1, y)
-        .speed(-1, 0) // move left
-        .collider(
-            1,
-            COLLIDER_FN {
-                if (TEST_HIT) {
-                    RWE.remove(receiver); // destroy enemy
-                    RWE.remove(peer);     // destroy bullet
-                }
-            })
-        .timer(
-            1,
-            TIMER_FN {
-                // Despawn if off screen
-                auto &p = RWE.getPosition(receiver);
-                if (p.x < 1) {
-                    RWE.remove(receiver);
-
-                    //
-                    RWE.reset(); // = Engine();
 
-                    RWE.make() //
-                        .text("   Game Over    ", "                ")
-                        .timer(
-                            20,
-                            TIMER_FN {
-                                RWE.reset(); // = Engine();
-                                setupHorizontalSpace();
-                            })
-                        .spawn();
-                }
-            })
-        .spawn();
+    RWE.spawnMany(PREFAB_ENEMY, 1, toggle ? nullptr : +[](uint16_t, Components::Position &p) { p.y = 1; });
 }
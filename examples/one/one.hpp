@@ -57,26 +57,25 @@ void setupOne()
                       .hitpoints(9)
                       .timer(
                           8, TIMER_FN {
-                              auto &t = RWE.getText(receiver);
                               auto &hp = RWE.getHitpoints(receiver);
                               if (hp.hp == 9)
-                                  t.line[0] = "9";
+                                  RWE.setTextLine(receiver, 0, "9");
                               if (hp.hp == 8)
-                                  t.line[0] = "8";
+                                  RWE.setTextLine(receiver, 0, "8");
                               if (hp.hp == 7)
-                                  t.line[0] = "7";
+                                  RWE.setTextLine(receiver, 0, "7");
                               if (hp.hp == 6)
-                                  t.line[0] = "6";
+                                  RWE.setTextLine(receiver, 0, "6");
                               if (hp.hp == 5)
-                                  t.line[0] = "5";
+                                  RWE.setTextLine(receiver, 0, "5");
                               if (hp.hp == 4)
-                                  t.line[0] = "4";
+                                  RWE.setTextLine(receiver, 0, "4");
                               if (hp.hp == 3)
-                                  t.line[0] = "3";
+                                  RWE.setTextLine(receiver, 0, "3");
                               if (hp.hp == 2)
-                                  t.line[0] = "2";
+                                  RWE.setTextLine(receiver, 0, "2");
                               if (hp.hp == 1)
-                                  t.line[0] = "1";
+                                  RWE.setTextLine(receiver, 0, "1");
 
                               auto &p = RWE.getPosition(receiver);
                               RWE //
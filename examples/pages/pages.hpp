@@ -5,27 +5,31 @@
 
 using namespace rwe ;
 
+void firstPageInput(const EntityId &, const RawControlState &rawInput)
+{
+    if (rawInput.right)
+        SWITCH_PAGE(1);
+}
+
+void secondPageInput(const EntityId &, const RawControlState &rawInput)
+{
+    if (rawInput.left)
+        SWITCH_PAGE(0);
+}
+
+// Page contents as constant tables, kept in flash on AVR
+constexpr SceneActor firstPage[] RW_PROGMEM = {
+    SceneActor().text("First Page     >").input(firstPageInput),
+};
+
+constexpr SceneActor secondPage[] RW_PROGMEM = {
+    SceneActor().text("< Second Page   ").input(secondPageInput),
+};
+
 void setupPages()
 {
-    SET_PAGE_(0, {
-        page.make() //
-            .text("First Page     >")
-            .input(INPUT_FN {
-                if (rawInput.right)
-                    SWITCH_PAGE(1);
-            })
-            .spawn();
-    });
-
-    SET_PAGE_(1, {
-        page.make() //
-            .text("< Second Page   ")
-            .input(INPUT_FN {
-                if (rawInput.left)
-                    SWITCH_PAGE(0);
-            })
-            .spawn();
-    });
+    SET_PAGE_(0, { page.loadScene(firstPage); });
+    SET_PAGE_(1, { page.loadScene(secondPage); });
 
     SWITCH_PAGE(0);
 }
@@ -8,22 +8,24 @@
 
 using namespace rwe ;
 
+// Typed shared value: the current character
+using CurrentChar = SharedKey<uint8_t>;
+
 void setupScreensaver(){
     
     RWE.make()
       .text("-")
       .speed(1,0)
       .timer(1,TIMER_FN{
-        auto v = RWE.sharedData.getElement(0);
-        v.uint8[0]++;
-        RWE.sharedData.setElement(0,v);
+        auto& c = RWE.sharedData.get<CurrentChar>();
+        c++;
 
-        auto& t = RWE.getText(receiver);
         static char buf[2];
-        buf[0] = v.uint8[0];
+        buf[0] = c;
         buf[1] = 0;
 
-        t.line[0] = buf;
+        // NB: the length is cached, set the line again after changing buf
+        RWE.setTextLine(receiver, 0, buf);
 
         auto& p = RWE.getPosition(receiver);
         auto& s = RWE.getSpeed(receiver);
@@ -3,13 +3,21 @@
 
 #pragma once
 
+// the body is the head's trail
+#ifndef RW_SETUP_MAX_TRAIL
+#define RW_SETUP_MAX_TRAIL 1
+#endif
+#ifndef RW_SETUP_TRAIL_LENGTH
+#define RW_SETUP_TRAIL_LENGTH 32
+#endif
+
 #include "rowguelike.hpp"
-#include <assert.h>
 #include <stdlib.h>
 
 using namespace rwe ;
 
-constexpr int8_t maxElements{32};
+// NB: the trail also keeps the position the head is leaving
+constexpr int8_t maxElements{Setup::TrailLength - 1};
 
 bool isOutOfBounds(int8_t x, int8_t y)
 {
@@ -26,68 +34,73 @@ bool isOutOfBounds(int8_t x, int8_t y)
 }
 
 // Forward declarations
+struct Snake;
 Optional<EntityId> spawnFood();
 void snakeCollider(const EntityId &receiver, const EntityId peer);
 void snakeTimer(const EntityId &receiver);
 
+// Typed shared value: the game instance for the callbacks
+using SnakeInstance = SharedKey<Snake *>;
+
 // -----
 
+// Initial snake: head, the body is drawn from its trail
+constexpr SceneActor snakeScene[] RW_PROGMEM = {
+    SceneActor(/*Actor::Move |*/ Actor::Collider | /*Actor::Control |*/ Actor::Health)
+        .text("@")
+        .position(Setup::ScreenWidth / 2, Setup::ScreenHeight / 2)
+        .speed(1, 0, true) // moving right
+        .collider(1, snakeCollider)
+        .input(NonInvertingControl)
+        .hitpoints(1)
+        .trail(2, "o"),
+};
+
 struct Snake
 {
-    EntityId segments[maxElements]; // head is segments[0]
-    uint8_t segmentsSize{0};
+    EntityId head{0};
     Optional<EntityId> food{0};
 
     void grow() {
-        auto &engine = Engine::get();
-        EntityId last = segments[segmentsSize - 1];
-        auto &pos = engine.getPosition(last);
-        auto newSegment = engine.make(/*Actor::Move |*/ /*Actor::Control*/)
-                              .text("o")
-                              .position(pos.x, pos.y)
-                              .speed(0, 0, true)
-                              // .collider(1, snakeCollider)
-                              .hitpoints(1)
-                              .spawn();
-        if (newSegment.has_value()) {
-            segments[segmentsSize] = (newSegment.value());
-            segmentsSize++;
-            assert(segmentsSize < maxElements);
-        }
+        auto &trail = RWE.getTrail(head);
+        if (trail.length < maxElements)
+            trail.length++;
     }
 
     void moveSegments() {
         auto &engine = Engine::get();
 
-        // Move tail segments to follow the one before them
-        for (int i = (int) segmentsSize - 1; i > 0; --i) {
-            auto &currPos = engine.getPosition(segments[i]);
-            auto &prevPos = engine.getPosition(segments[i - 1]);
-            currPos.x = prevPos.x;
-            currPos.y = prevPos.y;
-        }
-
-        // Move head by its speed
-        auto &headSpeed = engine.getSpeed(segments[0]);
-        auto &headPos = engine.getPosition(segments[0]);
+        // Move head by its speed, the body follows through the trail
+        auto &headSpeed = engine.getSpeed(head);
+        auto &headPos = engine.getPosition(head);
         headPos.x += headSpeed.vx;
         headPos.y += headSpeed.vy;
 
         // Check out of bounds
-        if (isOutOfBounds(headPos.x, headPos.y))
+        if (isOutOfBounds(headPos.x, headPos.y)) {
             reset();
+            return;
+        }
+
+        // If snake head hits its own body, reset game
+        // NB: the last segment moves away in this step
+        const auto &trail = engine.getTrail(head);
+        const uint8_t first = trail.firstAge(headPos);
+        int8_t x, y;
+        for (uint8_t age = first; age + 1 < first + trail.length && trail.at(age, x, y); age++) {
+            if (x == headPos.x && y == headPos.y) {
+                reset();
+                return;
+            }
+        }
     }
 
     void reset() {
         auto &engine = Engine::get();
 
-        segmentsSize = 0;
-
         engine.reset(); // = Engine();
 
-        SharedData::Element e;
-        e.ptr = this;
-        RWE.sharedData.setElement(0, e);
+        RWE.sharedData.get<SnakeInstance>() = this;
 
         A::Background(' ').spawn();
 
@@ -97,41 +110,12 @@ struct Snake
     }
 
     void spawnInitial() {
-        auto &engine = Engine::get();
-
-        // Spawn snake head
-        auto head = engine
-                        .make(/*Actor::Move |*/ Actor::Collider | /*Actor::Control |*/ Actor::Health)
-                        .text("@")
-                        .position(Setup::ScreenWidth / 2, Setup::ScreenHeight / 2)
-                        .speed(1, 0, true) // moving right
-                        .collider(1, snakeCollider)
-                        .input(NonInvertingControl)
-                        .hitpoints(1)
-                        .spawn();
-
-        if (head.has_value()) {
-            segments[segmentsSize] = head.value();
-            segmentsSize++;
-            assert(segmentsSize < maxElements);
-        }
+        // Spawn snake head from the scene table, with 2 tail segments behind it
+        RWE.loadScene(snakeScene, &head);
 
-        // Spawn tail segments
-        for (int i = 1; i <= 2; ++i) {
-            auto tail = engine.make(/*Actor::Move |*/ Actor::Collider | Actor::Health)
-                            .text("o")
-                            .position(Setup::ScreenWidth / 2 - i, Setup::ScreenHeight / 2)
-                            // .speed(0, 0)
-                            .collider(1, snakeCollider)
-                            .hitpoints(1)
-                            .spawn();
-
-            if (tail.has_value()) {
-                segments[segmentsSize] = tail.value();
-                segmentsSize++;
-                assert(segmentsSize < maxElements);
-            }
-        }
+        auto &trail = RWE.getTrail(head);
+        trail.push(Setup::ScreenWidth / 2 - 2, Setup::ScreenHeight / 2);
+        trail.push(Setup::ScreenWidth / 2 - 1, Setup::ScreenHeight / 2);
 
         // Spawn food
         auto maybeFood = spawnFood();
@@ -145,7 +129,7 @@ struct Snake
 
 void snakeCollider(const EntityId &receiver, const EntityId peer)
 {
-    Snake *ptr = static_cast<Snake *>(RWE.sharedData.getElement(0).ptr);
+    Snake *ptr = RWE.sharedData.get<SnakeInstance>();
 
     auto &engine = Engine::get();
     auto &receiverPos = engine.getPosition(receiver);
@@ -167,16 +151,6 @@ void snakeCollider(const EntityId &receiver, const EntityId peer)
             ptr->food = spawnFood();
             return;
         }
-
-        // If snake head hits its own body or out of bounds, reset game
-        for (auto segment : ptr->segments) {
-            if (segment == receiver)
-                continue;
-            if (peer == segment) {
-                ptr->reset();
-                return;
-            }
-        }
     }
 
     if (isOutOfBounds(receiverPos.x, receiverPos.y)) {
@@ -204,8 +178,8 @@ Optional<EntityId> spawnFood()
 // The timer function will run every frame to move the snake segments
 void snakeTimer(const EntityId &receiver)
 {
-    // Retrieve snake instance from sharedData.ptr in element 0
-    Snake *ptr = static_cast<Snake *>(RWE.sharedData.getElement(0).ptr);
+    // Retrieve snake instance from the typed shared value
+    Snake *ptr = RWE.sharedData.get<SnakeInstance>();
     if (ptr) {
         ptr->moveSegments();
     }
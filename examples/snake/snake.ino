@@ -1,3 +1,6 @@
+#define RW_SETUP_MAX_TRAIL 1 // the body is the head's trail
+#define RW_SETUP_TRAIL_LENGTH 32
+
 #include "r_lcd.hpp"
 #include "snake.hpp"
 
@@ -54,6 +54,16 @@ struct RowguelikeLCD
             lcd_->setCursor(x, y);
             lcd_->write(id);
         };
+        // changed parts of the buffer at the end of each frame:
+        RWE.drawContext.peerUpdateText =
+            +[](void *ctx, int8_t x, int8_t y, const char *txt, uint8_t len) {
+                if (!ctx)
+                    return;
+
+                auto lcd_ = (LiquidCrystal *) ctx;
+                lcd_->setCursor(x, y);
+                lcd_->write(txt, len);
+            };
         // direct draw command for disableDirectBufferDraw==1 mode:
         RWE.drawContext.peerAddText = +[](void *ctx, int8_t x, int8_t y, const char *txt) {
             if (!ctx)
@@ -106,15 +116,9 @@ struct RowguelikeLCD
         RWE.rawInput.right = m_right.get();
 
         // put your main code here, to run repeatedly:
+        // NB: changed parts of the buffer are sent with peerUpdateText
         RWE.runLoop();
 
-        if (!RWE.drawContext.disableDirectBufferDraw) {
-            lcd.setCursor(0, 0);
-            lcd.print(RWE.drawContext.buffer[0]);
-            lcd.setCursor(0, 1);
-            lcd.print(RWE.drawContext.buffer[1]);
-        }
-
         delay(delayTime);
     }
 };
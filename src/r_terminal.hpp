@@ -2,12 +2,18 @@
 
 #ifndef ARDUINO
 
-#include <iostream>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "rowguelike.hpp"
 
+/// Single key with a timeout, switches terminal mode on each call
+/// NB: terminalRunLoop uses TerminalSession instead
 char getch_with_timeout(int timeout_ms, char default_value)
 {
     struct termios oldt, newt;
@@ -32,50 +38,320 @@ char getch_with_timeout(int timeout_ms, char default_value)
         return default_value; // timeout occurred
 }
 
-void terminalRunLoop(const size_t timeout = 100)
+static inline uint64_t monotonicMicros()
 {
-    // -----
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
 
-    while (true) {
-        std::cout << "\033[2J\033[H"; // clear screen
+/// Raw (non-canonical, no echo) terminal input for the lifetime of the object
+/// Keys: WASD / arrows, SPACE: select, 'q' or Ctrl-C: quit
+struct TerminalSession
+{
+    TerminalSession()
+    {
+        _isTerminal = tcgetattr(STDIN_FILENO, &_saved) == 0;
+        if (_isTerminal) {
+            auto raw = _saved;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        }
+
+        _interrupted() = 0;
+        struct sigaction sa {};
+        sa.sa_handler = +[](int) { _interrupted() = 1; };
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, &_savedInt);
+        sigaction(SIGTERM, &sa, &_savedTerm);
+    }
+
+    ~TerminalSession()
+    {
+        if (_isTerminal)
+            tcsetattr(STDIN_FILENO, TCSANOW, &_saved);
+
+        sigaction(SIGINT, &_savedInt, nullptr);
+        sigaction(SIGTERM, &_savedTerm, nullptr);
+    }
 
-        std::cout << "Inputs: " << RWE.rawInput.left << RWE.rawInput.right << RWE.rawInput.up
-                  << RWE.rawInput.down << RWE.rawInput.select << "\n";
+    TerminalSession(const TerminalSession &) = delete;
+    TerminalSession &operator=(const TerminalSession &) = delete;
 
-        std::cout << "##";
-        for (int i = 0; i < rwe::Setup::ScreenWidth; i++)
-            std::cout << "#";
-        std::cout << "##\n";
+    /// Keys seen since the last takeInput()
+    rwe::RawControlState pending{};
 
-        for (int i = 0; i < rwe::Setup::ScreenHeight; i++) {
-            std::cout << "# ";
-            for (int x = 0; x < rwe::Setup::ScreenWidth; x++) {
-                auto c = RWE.drawContext.buffer[i][x];
-                std::cout << ((c >= 32) ? c : ' ');
+    bool quit() const { return _quit || _interrupted(); }
+
+    /// Returns keys collected since the last call and clears them
+    rwe::RawControlState takeInput()
+    {
+        auto ret = pending;
+        pending = rwe::RawControlState();
+        return ret;
+    }
+
+    /// Collects all keys arriving until 'deadline' (monotonicMicros), returns early on quit
+    void readUntil(uint64_t deadline)
+    {
+        while (!quit()) {
+            const auto now = monotonicMicros();
+            if (now >= deadline)
+                return;
+
+            // NB: end of piped input or less than poll() resolution left: just wait
+            const auto left = deadline - now;
+            if (_eof || left < 1000) {
+                usleep(useconds_t(left));
+                drain();
+                return;
             }
-            std::cout << " #\n";
+
+            pollfd fd{STDIN_FILENO, POLLIN, 0};
+            if (::poll(&fd, 1, int(left / 1000)) > 0)
+                drain();
         }
+    }
 
-        std::cout << "##";
-        for (int i = 0; i < rwe::Setup::ScreenWidth; i++)
-            std::cout << "#";
-        std::cout << "##\n";
+    /// Reads all pending bytes without blocking
+    void drain()
+    {
+        char buf[64];
+        while (true) {
+            pollfd fd{STDIN_FILENO, POLLIN, 0};
+            if (::poll(&fd, 1, 0) <= 0)
+                return;
 
-        char ch = getch_with_timeout(timeout, '*'); //getch();
+            const auto r = read(STDIN_FILENO, buf, sizeof(buf));
+            if (r <= 0) {
+                _eof = _eof || r == 0;
+                return;
+            }
+            for (int i = 0; i < r; i++)
+                decode(buf[i]);
+        }
+    }
 
-        if (ch == 'q')
-            break;
+protected:
+    termios _saved{};
+    bool _isTerminal{false};
+    struct sigaction _savedInt{};
+    struct sigaction _savedTerm{};
 
-        RWE.rawInput.left = ch == 'a';
-        RWE.rawInput.right = ch == 'd';
-        RWE.rawInput.up = ch == 'w';
-        RWE.rawInput.down = ch == 's';
-        RWE.rawInput.select = ch == ' ';
+    bool _quit{false};
+    bool _eof{false};
 
-        // sleep(1);
+    /// Escape sequence state: 0 none, 1 after ESC, 2 after ESC [
+    uint8_t _escape{0};
 
-        RWE.runLoop();
+    static volatile sig_atomic_t &_interrupted()
+    {
+        static volatile sig_atomic_t flag{0};
+        return flag;
     }
+
+    void decode(char c)
+    {
+        if (_escape == 1) {
+            _escape = (c == '[' || c == 'O') ? 2 : 0;
+            return;
+        }
+        if (_escape == 2) {
+            _escape = 0;
+            switch (c) {
+            case 'A': pending.up = true; break;
+            case 'B': pending.down = true; break;
+            case 'C': pending.right = true; break;
+            case 'D': pending.left = true; break;
+            }
+            return;
+        }
+
+        switch (c) {
+        case '\033': _escape = 1; break;
+        case 'a': pending.left = true; break;
+        case 'd': pending.right = true; break;
+        case 'w': pending.up = true; break;
+        case 's': pending.down = true; break;
+        case ' ': pending.select = true; break;
+        case 'q': _quit = true; break;
+        }
+    }
+};
+
+/// Collects changed parts of the frame as ANSI sequences and writes them with a single write()
+/// Layout: status line, bordered screen; uses the alternate screen with hidden cursor
+struct AnsiPresenter
+{
+    // NB: full frame with a cursor move per row fits without an intermediate flush
+    static constexpr size_t Capacity{(rwe::Setup::ScreenHeight + 3) * (rwe::Setup::ScreenWidth + 16)
+                                     + 64};
+
+    static constexpr int ScreenRow{3};
+    static constexpr int ScreenColumn{3};
+
+    char data[Capacity];
+    size_t size{0};
+
+    void append(const char *txt, size_t len)
+    {
+        if (size + len > Capacity)
+            flush();
+        if (len > Capacity) {
+            writeAll(txt, len);
+            return;
+        }
+
+        memcpy(&data[size], txt, len);
+        size += len;
+    }
+    void append(const char *txt) { append(txt, strlen(txt)); }
+
+    /// 1-based terminal position
+    void moveTo(int row, int column)
+    {
+        char seq[16];
+        const int len = snprintf(seq, sizeof(seq), "\033[%d;%dH", row, column);
+        append(seq, len);
+    }
+
+    /// Run of screen cells, non-printable characters are shown as spaces
+    void text(int8_t x, int8_t y, const char *txt, uint8_t len)
+    {
+        moveTo(ScreenRow + y, ScreenColumn + x);
+
+        if (size + len > Capacity)
+            flush();
+        for (int i = 0; i < len; i++)
+            data[size++] = (txt[i] >= 32) ? txt[i] : ' ';
+    }
+
+    void status(const rwe::RawControlState &input)
+    {
+        const char line[] = {char('0' + input.left),
+                             char('0' + input.right),
+                             char('0' + input.up),
+                             char('0' + input.down),
+                             char('0' + input.select)};
+        if (memcmp(line, _lastStatus, sizeof(line)) == 0)
+            return;
+        memcpy(_lastStatus, line, sizeof(line));
+
+        moveTo(1, 1);
+        append("Inputs: ");
+        append(line, sizeof(line));
+    }
+
+    /// Sends changed runs of the engine's buffer here
+    void attach(rwe::DrawContext &dc)
+    {
+        dc.ctx = this;
+        dc.peerUpdateText = +[](void *ctx, int8_t x, int8_t y, const char *txt, uint8_t len) {
+            static_cast<AnsiPresenter *>(ctx)->text(x, y, txt, len);
+        };
+        dc.invalidate();
+    }
+
+    /// Enter alternate screen, hide cursor, draw border
+    void begin()
+    {
+        append("\033[?1049h\033[?25l\033[2J");
+
+        border(ScreenRow - 1);
+        for (int y = 0; y < rwe::Setup::ScreenHeight; y++) {
+            moveTo(ScreenRow + y, 1);
+            append("#");
+            moveTo(ScreenRow + y, ScreenColumn + rwe::Setup::ScreenWidth + 1);
+            append("#");
+        }
+        border(ScreenRow + rwe::Setup::ScreenHeight);
+
+        memset(_lastStatus, 0, sizeof(_lastStatus));
+    }
+
+    /// Restore cursor and main screen
+    void end()
+    {
+        append("\033[?25h\033[?1049l");
+        flush();
+    }
+
+    void flush()
+    {
+        writeAll(data, size);
+        size = 0;
+    }
+
+protected:
+    char _lastStatus[5]{};
+
+    void border(int row)
+    {
+        moveTo(row, 1);
+        for (int i = 0; i < rwe::Setup::ScreenWidth + 4; i++)
+            append("#", 1);
+    }
+
+    static void writeAll(const char *txt, size_t len)
+    {
+        while (len > 0) {
+            const auto r = write(STDOUT_FILENO, txt, len);
+            if (r <= 0)
+                return;
+            txt += r;
+            len -= r;
+        }
+    }
+};
+
+/// Runs the engine every 'timeout' ms regardless of input, presents every 'presentTime' ms
+/// (0: after each frame); returns measured tick / present jitter
+rwe::Scheduler::Stats terminalRunLoop(const size_t timeout = 100, const size_t presentTime = 0)
+{
+    static AnsiPresenter presenter;
+    presenter.attach(RWE.drawContext);
+    presenter.begin();
+
+    // -----
+
+    // current buffer before the first frame
+    RWE.drawContext._begin();
+    RWE.drawContext._end();
+    presenter.status(RWE.rawInput);
+    presenter.flush();
+
+    TerminalSession session;
+    rwe::Scheduler scheduler(timeout * 1000, presentTime * 1000);
+
+    // first frame after one tick period
+    scheduler.start(uint32_t(monotonicMicros() + timeout * 1000));
+
+    while (true) {
+        const auto now = monotonicMicros();
+        session.readUntil(now + scheduler.timeToNext(uint32_t(now)));
+
+        if (session.quit())
+            break;
+
+        const auto ticks = scheduler.ticksDue(uint32_t(monotonicMicros()));
+        for (int i = 0; i < ticks; i++) {
+            // all keys pressed since the last frame go to the first one
+            RWE.rawInput = i == 0 ? session.takeInput() : rwe::RawControlState();
+            // NB: the buffer is diffed once per present, not per tick
+            RWE.runLoop(false);
+        }
+
+        if (scheduler.presentDue(uint32_t(monotonicMicros()))) {
+            RWE.present();
+            presenter.status(RWE.rawInput);
+            presenter.flush();
+        }
+    }
+
+    presenter.end();
+    return scheduler.stats;
 }
 
 #endif
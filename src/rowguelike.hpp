@@ -5,6 +5,35 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(RW_SETUP_PROFILE) && RW_SETUP_PROFILE
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+/// Places constant tables in flash, e.g. scene tables for Engine::loadScene()
+#define RW_PROGMEM PROGMEM
+#define _RW_READ_PROGMEM(dst, src, size) memcpy_P(dst, src, size)
+#else
+#define RW_PROGMEM
+#define _RW_READ_PROGMEM(dst, src, size) memcpy(dst, src, size)
+#endif
+
+// placement new, bare AVR toolchains ship no <new>
+#if defined(__has_include)
+#if __has_include(<new>)
+#include <new>
+#define _RW_HAS_NEW 1
+#endif
+#endif
+#ifndef _RW_HAS_NEW
+inline void* operator new(size_t, void* p) noexcept { return p; }
+#endif
+
 namespace rwe {
 
 // ------------------------------------------------------------------------------
@@ -26,6 +55,11 @@ namespace rwe {
 #define RW_SETUP_TAGS 32
 #endif
 
+/// Tag groups with any number of members, one bit per actor each (up to 32 groups)
+#ifndef RW_SETUP_TAG_GROUPS
+#define RW_SETUP_TAG_GROUPS 8
+#endif
+
 #ifndef RW_SETUP_SHARED_NUMBERS
 #define RW_SETUP_SHARED_NUMBERS 8
 #endif
@@ -54,6 +88,80 @@ namespace rwe {
 #define RW_SETUP_WITH_3D false
 #endif
 
+/// Per-system timing and counters in Engine::profile
+#ifndef RW_SETUP_PROFILE
+#define RW_SETUP_PROFILE false
+#endif
+
+/// Only call collider functions for actors in the same or nearby screen cells
+#ifndef RW_SETUP_COLLISION_BROADPHASE
+#define RW_SETUP_COLLISION_BROADPHASE false
+#endif
+
+/// Broadphase neighbourhood in cells around the collider: 0 = same cell only
+#ifndef RW_SETUP_COLLISION_NEIGHBOURHOOD
+#define RW_SETUP_COLLISION_NEIGHBOURHOOD 0
+#endif
+
+/// Entity id width: 8 (up to 255 actors) or 16 (up to 65535 actors, host only)
+#ifndef RW_SETUP_ENTITY_BITS
+#define RW_SETUP_ENTITY_BITS 8
+#endif
+
+/// Generation counter per actor slot for Engine::handle() / isValid(), one byte per actor
+#ifndef RW_SETUP_HANDLES
+#define RW_SETUP_HANDLES (RW_SETUP_ENTITY_BITS == 16)
+#endif
+
+/// Commands recorded while runLoop() systems run: 0 = spawn / remove / reset apply immediately
+#ifndef RW_SETUP_COMMAND_BUFFER
+#define RW_SETUP_COMMAND_BUFFER 0
+#endif
+
+/// Enabled components and systems as a mask of Actor flags, e.g. (Actor::Text | Actor::Input)
+/// NB: disabled components have no storage, builder methods fail to compile, systems are empty
+#ifndef RW_SETUP_FEATURES
+#define RW_SETUP_FEATURES Actor::All
+#endif
+
+/// Prefab slots for Engine::setPrefab() / spawnMany()
+#ifndef RW_SETUP_PREFABS
+#define RW_SETUP_PREFABS 8
+#endif
+
+/// Text lines shared by all actors, an actor uses one per line up to its last one
+/// 0 = one per actor, plus up to a full screen while the pool is no bigger than a line pointer per actor and row
+#ifndef RW_SETUP_TEXT_LINES
+#define RW_SETUP_TEXT_LINES 0
+#endif
+
+/// Sparse storage size for rarely used components: 0 = one per actor
+/// NB: spawn fails if the storage is full
+#ifndef RW_SETUP_MAX_HITPOINTS
+#define RW_SETUP_MAX_HITPOINTS 0
+#endif
+#ifndef RW_SETUP_MAX_INPUT
+#define RW_SETUP_MAX_INPUT 0
+#endif
+#ifndef RW_SETUP_MAX_TIMER
+#define RW_SETUP_MAX_TIMER 0
+#endif
+#ifndef RW_SETUP_MAX_COLLIDER
+#define RW_SETUP_MAX_COLLIDER 0
+#endif
+/// NB: sparse by default, few actors are children
+#ifndef RW_SETUP_MAX_PARENT
+#define RW_SETUP_MAX_PARENT 8
+#endif
+/// Actors with a position trail: 0 = no trails
+#ifndef RW_SETUP_MAX_TRAIL
+#define RW_SETUP_MAX_TRAIL 0
+#endif
+/// Positions kept per trail
+#ifndef RW_SETUP_TRAIL_LENGTH
+#define RW_SETUP_TRAIL_LENGTH 16
+#endif
+
 // <=0.0.3 definitios: display error
 #define _RW_DEFINE_ERROR_DEPRECATED_MACRO(NAME) \
     template<typename T = void> \
@@ -77,6 +185,47 @@ _RW_DEFINE_ERROR_DEPRECATED_MACRO(RW_SETUP_WITH_3D)
 // ------------------------------------------------------------------------------
 // Typed values for Setup
 
+/// Unsigned type of entity ids for RW_SETUP_ENTITY_BITS
+template <uint8_t Bits>
+struct _EntityIdT {
+    static_assert(Bits == 8 || Bits == 16, "RW_SETUP_ENTITY_BITS must be 8 or 16");
+    using type = uint8_t;
+};
+template <>
+struct _EntityIdT<16> {
+    using type = uint16_t;
+};
+
+/// Line of the text pool with its length, measured once when the line is set, see Components::TextLine
+struct _TextLine {
+    const char *text { nullptr };
+    uint8_t length {};
+};
+
+static constexpr uint32_t _Min(uint32_t a, uint32_t b) { return a < b ? a : b; }
+static constexpr uint32_t _Max(uint32_t a, uint32_t b) { return a > b ? a : b; }
+
+/// Pool lines fitting 'bytes', a pool line also takes a bit of the used lines set
+static constexpr uint32_t _TextLinesIn(uint32_t bytes) { return bytes * 8 / (8 * sizeof(_TextLine) + 1); }
+
+/// Bytes per actor of the ScreenHeight pointers Components::Text used to hold, minus the actor's run
+static constexpr uint32_t _TextBytesPerActor(uint8_t height, uint8_t bits)
+{
+    return _Max(height * sizeof(const char*), 2 * (bits / 8)) - 2 * (bits / 8);
+}
+
+/// Default pool size: one line per actor, up to a full screen more while the pool costs no more than before
+static constexpr uint32_t _TextDefault(uint32_t actors, uint8_t height, uint8_t bits)
+{
+    return _Min(actors + height, _Max(actors, _TextLinesIn(actors * _TextBytesPerActor(height, bits))));
+}
+
+/// Text pool size for RW_SETUP_TEXT_LINES, pool indices are as wide as entity ids
+static constexpr uint16_t _TextLines(uint16_t lines, uint16_t actors, uint8_t height, uint8_t bits)
+{
+    return uint16_t(_Min(lines ? lines : _TextDefault(actors, height, bits), bits == 8 ? 0x100 : 0xFFFF));
+}
+
 struct Setup {
     /// Minimal screen is a 1x1, unfortunatyely the 0x0 LCD is not supported
     static constexpr uint8_t ScreenWidth{RW_SETUP_SCREEN_WIDTH > 0 ? RW_SETUP_SCREEN_WIDTH : 1};
@@ -85,8 +234,12 @@ struct Setup {
     static constexpr uint8_t LastSymbolX{ScreenWidth - 1};
     static constexpr uint8_t LastSymbolY{ScreenHeight - 1};
 
-    static constexpr uint8_t Actors { RW_SETUP_ACTORS };
+    static constexpr uint8_t EntityBits { RW_SETUP_ENTITY_BITS };
+    /// NB: Actors is also the 'no actor' marker, so it stays below 2^EntityBits
+    static constexpr _EntityIdT<EntityBits>::type Actors { RW_SETUP_ACTORS };
+    static constexpr bool Handles { RW_SETUP_HANDLES };
     static constexpr uint8_t Tags { RW_SETUP_TAGS };
+    static constexpr uint8_t TagGroups { RW_SETUP_TAG_GROUPS };
     static constexpr uint8_t SharedNumbers { RW_SETUP_SHARED_NUMBERS };
     static constexpr uint8_t SharedStrings { RW_SETUP_SHARED_STRINGS };
 
@@ -104,6 +257,39 @@ struct Setup {
     static constexpr uint8_t PageCount{RW_SETUP_PAGE_COUNT};
 
     static constexpr bool With3D{RW_SETUP_WITH_3D};
+
+    static constexpr bool CollisionBroadphase{RW_SETUP_COLLISION_BROADPHASE};
+    static constexpr uint8_t CollisionNeighbourhood{RW_SETUP_COLLISION_NEIGHBOURHOOD};
+
+    static constexpr bool Profile{RW_SETUP_PROFILE};
+
+    static constexpr uint8_t CommandBuffer{RW_SETUP_COMMAND_BUFFER};
+    static constexpr uint8_t Prefabs{RW_SETUP_PREFABS};
+
+    static constexpr uint8_t MaxHitpoints{RW_SETUP_MAX_HITPOINTS};
+    static constexpr uint8_t MaxInput{RW_SETUP_MAX_INPUT};
+    static constexpr uint8_t MaxTimer{RW_SETUP_MAX_TIMER};
+    static constexpr uint8_t MaxCollider{RW_SETUP_MAX_COLLIDER};
+    static constexpr uint8_t MaxParent{RW_SETUP_MAX_PARENT};
+    static constexpr uint8_t MaxTrail{RW_SETUP_MAX_TRAIL};
+    static constexpr uint8_t TrailLength{RW_SETUP_TRAIL_LENGTH > 0 ? RW_SETUP_TRAIL_LENGTH : 1};
+    static constexpr uint16_t TextLines{_TextLines(RW_SETUP_TEXT_LINES, Actors, ScreenHeight, EntityBits)};
+};
+
+/// Setup with another screen size and capacity, e.g. EngineT<SetupT<40, 25, 128>>
+/// NB: other values are the RW_SETUP_* ones
+template <uint8_t Width, uint8_t Height, uint16_t ActorCount = Setup::Actors, uint8_t TagCount = Setup::Tags>
+struct SetupT : Setup {
+    static constexpr uint8_t ScreenWidth{Width > 0 ? Width : 1};
+    static constexpr uint8_t ScreenHeight{Height > 0 ? Height : 1};
+
+    static constexpr uint8_t LastSymbolX{ScreenWidth - 1};
+    static constexpr uint8_t LastSymbolY{ScreenHeight - 1};
+
+    static constexpr _EntityIdT<EntityBits>::type Actors{ActorCount};
+    static constexpr uint8_t Tags{TagCount};
+
+    static constexpr uint16_t TextLines{_TextLines(RW_SETUP_TEXT_LINES, Actors, ScreenHeight, EntityBits)};
 };
 
 // ------------------------------------------------------------------------------
@@ -174,12 +360,90 @@ private:
     }
 };
 
+// ------------------------------------------------------------------------------
+// Fixed-size bit set for slot bookkeeping
+
+static inline uint8_t _CountTrailingZeros(uint32_t v)
+{
+    return __builtin_ctzl(v);
+}
+
+static inline uint8_t _CountOnes(uint32_t v)
+{
+    return __builtin_popcountl(v);
+}
+
+template <uint16_t Bits>
+struct BitSet {
+    using Word = uint32_t;
+    static constexpr uint8_t WordBits { 32 };
+    static constexpr uint16_t Words { (Bits + WordBits - 1) / WordBits };
+
+    Word words[Words] {};
+
+    void set(uint16_t i) { words[i / WordBits] |= Word(1) << (i % WordBits); }
+    void reset(uint16_t i) { words[i / WordBits] &= ~(Word(1) << (i % WordBits)); }
+    bool test(uint16_t i) const { return (words[i / WordBits] >> (i % WordBits)) & 1; }
+
+    void clearAll()
+    {
+        for (auto& w : words)
+            w = 0;
+    }
+
+    /// Bits of word 'w' that are below 'Bits'
+    static constexpr Word validBits(uint16_t w)
+    {
+        return (w == Words - 1 && Bits % WordBits) ? (Word(1) << (Bits % WordBits)) - 1 : ~Word(0);
+    }
+
+    /// NB: bits past 'Bits' in the last word are kept clear
+    void setAll()
+    {
+        for (uint16_t w = 0; w < Words; w++)
+            words[w] = validBits(w);
+    }
+
+    bool any() const
+    {
+        for (auto& w : words)
+            if (w)
+                return true;
+        return false;
+    }
+
+    uint16_t count() const
+    {
+        uint16_t ret = 0;
+        for (auto& w : words)
+            ret += _CountOnes(w);
+        return ret;
+    }
+
+    /// Index of the lowest set bit or 'Bits' if none
+    uint16_t first() const
+    {
+        for (uint16_t i = 0; i < Words; i++)
+            if (words[i])
+                return i * WordBits + _CountTrailingZeros(words[i]);
+        return Bits;
+    }
+};
+
 // ------------------------------------------------------------------------------
 
 /// Entity Id provided by engine
-using EntityId = uint8_t;
+using EntityId = _EntityIdT<Setup::EntityBits>::type;
+
+/// Entity id with the generation of its slot, stale after the actor is removed
+/// NB: see Engine::handle() / Engine::isValid(), getters still take plain ids
+struct Handle {
+    EntityId id {};
+    uint8_t generation {};
+
+    bool operator==(const Handle& rhs) const { return id == rhs.id && generation == rhs.generation; }
+};
 
-struct DrawContext;
 
 /// Template for the control state
 template<typename T>
@@ -229,7 +493,10 @@ using RawControlState = _ControlStateT<bool>;
 using MomentaryControlState = _ControlStateT<MomentaryValue>;
 
 // ------------------------------------------------------------------------------
-using ActorFlags = uint8_t;
+using ActorFlags = uint16_t;
+
+/// Tag groups of an actor, one bit per group, see Engine::joinGroup()
+using GroupMask = uint32_t;
 
 /// Constructible by engine's spawn() method
 struct Actor {
@@ -243,6 +510,19 @@ struct Actor {
     static constexpr ActorFlags Text { 0x1 << 4 };
     static constexpr ActorFlags Input { 0x1 << 5 };
     static constexpr ActorFlags Timer { 0x1 << 6 };
+    /// Position follows the parent actor, see Engine::movementSystem()
+    static constexpr ActorFlags Child { 0x1 << 7 };
+    /// Draws the last positions, see Components::Trail
+    static constexpr ActorFlags Trail { 0x1 << 8 };
+
+    /// Flag bits in use, one actor set per bit
+    static constexpr uint8_t FlagCount { 9 };
+    static constexpr ActorFlags All { ActorFlags(~ActorFlags(0)) };
+
+    /// RW_SETUP_FEATURES, kept here as it is built from the flags above
+    static constexpr ActorFlags Features { ActorFlags(RW_SETUP_FEATURES) };
+    /// true if any of the flags is enabled
+    static constexpr bool enabled(ActorFlags f) { return (Features & f) != 0; }
 };
 
 // ------------------------------------------------------------------------------
@@ -264,7 +544,137 @@ using VoidFn = void (*)(void);
 // ------------------------------------------------------------------------------
 // Components storage
 
-struct Components {
+/// Sparse set: 'Max' components packed in a dense array, index map per actor
+/// NB: membership follows the component's actor flag, see Components::sync()
+template <typename T, uint8_t Max, typename Config = Setup>
+struct ComponentStorage {
+    static_assert(Max < 0xFF, "sparse component storage is limited to 254");
+    static constexpr uint8_t None { 0xFF };
+
+    T dense[Max] {};
+    EntityId owner[Max] {};
+    uint8_t index[Config::Actors];
+    uint8_t count { 0 };
+
+    ComponentStorage() { clear(); }
+
+    void clear()
+    {
+        for (auto& i : index)
+            i = None;
+        count = 0;
+    }
+
+    /// NB: only valid for actors having the component
+    T& operator[](EntityId id) { return dense[index[id]]; }
+
+    /// nullptr if the actor has no component
+    T* find(EntityId id) { return index[id] == None ? nullptr : &dense[index[id]]; }
+
+    bool hasRoom(EntityId id) const { return index[id] != None || count < Max; }
+
+    void add(EntityId id)
+    {
+        if (index[id] != None || count >= Max)
+            return;
+        index[id] = count;
+        owner[count] = id;
+        dense[count] = T();
+        count++;
+    }
+
+    /// Moves the last component into the gap
+    void remove(EntityId id)
+    {
+        const auto i = index[id];
+        if (i == None)
+            return;
+
+        count--;
+        dense[i] = dense[count];
+        owner[i] = owner[count];
+        index[owner[i]] = i;
+        index[id] = None;
+    }
+
+    void move(EntityId from, EntityId to)
+    {
+        index[to] = index[from];
+        index[from] = None;
+        if (index[to] != None)
+            owner[index[to]] = to;
+    }
+};
+
+/// Storage size of a component disabled by RW_SETUP_FEATURES
+static constexpr uint8_t ComponentDisabled { 0xFF };
+
+/// Storage size 'max' if any of the flags is enabled
+static constexpr uint8_t _ComponentSize(ActorFlags f, uint8_t max)
+{
+    return Actor::enabled(f) ? max : ComponentDisabled;
+}
+
+/// Component disabled by RW_SETUP_FEATURES: no storage, getters return the dummy
+template <typename T, typename Config>
+struct ComponentStorage<T, ComponentDisabled, Config> {
+    void clear() {}
+
+    /// NB: only reachable from code skipped for disabled features
+    T& operator[](EntityId)
+    {
+        static T none;
+        return none;
+    }
+    T* find(EntityId) { return nullptr; }
+
+    bool hasRoom(EntityId) const { return true; }
+    void add(EntityId) {}
+    void remove(EntityId) {}
+
+    void move(EntityId, EntityId) {}
+};
+
+/// ActorBuilder value of a component, no storage if the component is disabled
+template <typename T, bool Enabled>
+struct _BuilderValue {
+    T value {};
+
+    T& get() { return value; }
+    const T& get() const { return value; }
+};
+
+template <typename T>
+struct _BuilderValue<T, false> {
+    /// NB: only reachable from code skipped for disabled features
+    T& get()
+    {
+        static T none;
+        return none;
+    }
+    const T& get() const { return const_cast<_BuilderValue*>(this)->get(); }
+};
+
+/// Default: one component per actor
+template <typename T, typename Config>
+struct ComponentStorage<T, 0, Config> {
+    T data[Config::Actors] {};
+
+    void clear() {}
+
+    T& operator[](EntityId id) { return data[id]; }
+    T* find(EntityId id) { return &data[id]; }
+
+    bool hasRoom(EntityId) const { return true; }
+    void add(EntityId) {}
+    void remove(EntityId) {}
+
+    void move(EntityId from, EntityId to) { data[to] = data[from]; }
+};
+
+/// Component types and storages sized by Config, see Setup
+template <typename Config = Setup>
+struct ComponentsT {
     struct Position {
         int8_t x {}, y {};
         int8_t lookAt {};
@@ -273,8 +683,8 @@ struct Components {
             return x == rhs.x && y == rhs.y && lookAt == rhs.lookAt;
         }
 
-        void randomizeX() { x = rand() % Setup::ScreenWidth; }
-        void randomizeY() { y = rand() % Setup::ScreenHeight; }
+        void randomizeX() { x = rand() % Config::ScreenWidth; }
+        void randomizeY() { y = rand() % Config::ScreenHeight; }
         void randomize()
         {
             randomizeX();
@@ -290,21 +700,34 @@ struct Components {
     };
 
     struct Collider {
+        static constexpr uint8_t AllLayers { 0xFF };
+
         int8_t value {};
+        /// Layer id 0..7 and the mask of layers this collider interacts with
+        /// NB: next to 'value' so the bytes share the padding before the pointer
+        uint8_t layer {};
+        uint8_t mask { AllLayers };
+
         ColliderFn colliderFn { nullptr };
+
+        /// true if both colliders accept each other's layer
+        /// NB: only the low 3 bits of a layer are used
+        bool interacts(const Collider &rhs) const
+        {
+            return (mask >> (rhs.layer & 7)) & (rhs.mask >> (layer & 7)) & 1;
+        }
     };
     struct Input
     {
         InputFn inputFn{nullptr};
     };
+    /// Line of the text pool with its length, measured once when the line is set
+    using TextLine = _TextLine;
+    /// Lines 0..count-1 of the actor: a run of the engine's text pool
+    /// NB: set with Engine::setTextLine(), read with Engine::getTextLine()
     struct Text {
-        const char *line[Setup::ScreenHeight];
-
-        Text()
-        {
-            for (int i = 0; i < Setup::ScreenHeight; i++)
-                line[i] = nullptr;
-        }
+        EntityId first {};
+        uint8_t count {};
     };
     struct Timer {
         uint8_t currentFrame {};
@@ -312,16 +735,241 @@ struct Components {
         uint8_t frameCount {};
         TimerFn fn { nullptr };
     };
+    /// Last positions of the actor in a ring buffer, drawn as 'symbol' behind it
+    /// NB: a position is recorded by the movement system when it differs from the newest one
+    struct Trail {
+        static constexpr uint8_t Capacity { Config::MaxTrail ? Config::TrailLength : 1 };
+
+        int8_t x[Capacity] {}, y[Capacity] {};
+        uint8_t newest {};
+        uint8_t count {};
+
+        /// Drawn positions
+        uint8_t length {};
+        const char *symbol { nullptr };
+
+        void clear()
+        {
+            newest = 0;
+            count = 0;
+        }
+
+        void push(int8_t px, int8_t py)
+        {
+            newest = newest + 1 < Capacity ? newest + 1 : 0;
+            x[newest] = px;
+            y[newest] = py;
+            if (count < Capacity)
+                count++;
+        }
+
+        /// Position recorded 'age' pushes ago, 0 = newest; false if not recorded
+        bool at(uint8_t age, int8_t &px, int8_t &py) const
+        {
+            if (age >= count)
+                return false;
+            const uint8_t i = newest >= age ? newest - age : newest + Capacity - age;
+            px = x[i];
+            py = y[i];
+            return true;
+        }
+
+        /// Age of the first drawn position: the newest one is skipped while the actor is still on it
+        uint8_t firstAge(const Position &p) const
+        {
+            int8_t px, py;
+            return (at(0, px, py) && px == p.x && py == p.y) ? 1 : 0;
+        }
+    };
+    /// Parent actor and the offset from its position
+    struct Parent {
+        /// Longest parent chain followed, longer chains and cycles are cut
+        static constexpr uint8_t MaxDepth { 8 };
 
-    Position position[Setup::Actors] {};
-    Speed speed[Setup::Actors] {};
-    Hitpoints hitpoints[Setup::Actors] {};
+        EntityId id {};
+        int8_t dx {}, dy {};
+    };
+
+    ComponentStorage<Position, 0, Config> position {};
+    ComponentStorage<Speed, _ComponentSize(Actor::Move | Actor::Control, 0), Config> speed {};
+    ComponentStorage<Hitpoints, _ComponentSize(Actor::Health, Config::MaxHitpoints), Config> hitpoints {};
 
     //
-    Collider collider[Setup::Actors] {};
-    Input input[Setup::Actors]{};
-    Text text[Setup::Actors] {};
-    Timer timer[Setup::Actors] {};
+    ComponentStorage<Collider, _ComponentSize(Actor::Collider, Config::MaxCollider), Config> collider {};
+    ComponentStorage<Input, _ComponentSize(Actor::Input, Config::MaxInput), Config> input {};
+    ComponentStorage<Text, _ComponentSize(Actor::Text, 0), Config> text {};
+    ComponentStorage<Timer, _ComponentSize(Actor::Timer, Config::MaxTimer), Config> timer {};
+    ComponentStorage<Parent, _ComponentSize(Actor::Child, Config::MaxParent), Config> parent {};
+    ComponentStorage<Trail, Config::MaxTrail ? _ComponentSize(Actor::Trail, Config::MaxTrail) : ComponentDisabled, Config> trail {};
+
+    /// Component type -> actor flag and storage, used by Engine::each<Components...>()
+    /// NB: Position has no flag, every active actor has it
+#define _RW_COMPONENT_OF(Type, Flag, array)                              \
+    static constexpr ActorFlags flagOf(Type *) { return Flag; }          \
+    decltype(array) &storageOf(Type *) { return array; }
+
+    _RW_COMPONENT_OF(Position, 0, position)
+    _RW_COMPONENT_OF(Speed, Actor::Move, speed)
+    _RW_COMPONENT_OF(Hitpoints, Actor::Health, hitpoints)
+    _RW_COMPONENT_OF(Collider, Actor::Collider, collider)
+    _RW_COMPONENT_OF(Input, Actor::Input, input)
+    _RW_COMPONENT_OF(Text, Actor::Text, text)
+    _RW_COMPONENT_OF(Timer, Actor::Timer, timer)
+    _RW_COMPONENT_OF(Parent, Actor::Child, parent)
+    _RW_COMPONENT_OF(Trail, Actor::Trail, trail)
+
+#undef _RW_COMPONENT_OF
+
+    /// true if sparse storages can hold the components of flags 'f'
+    bool hasRoom(EntityId id, ActorFlags f) const
+    {
+        return (!(f & Actor::Health) || hitpoints.hasRoom(id)) && (!(f & Actor::Collider) || collider.hasRoom(id))
+            && (!(f & Actor::Input) || input.hasRoom(id)) && (!(f & Actor::Timer) || timer.hasRoom(id))
+            && (!(f & Actor::Child) || parent.hasRoom(id)) && (!(f & Actor::Trail) || trail.hasRoom(id));
+    }
+
+    /// Adds / removes sparse components to match flags 'f'
+    void sync(EntityId id, ActorFlags f)
+    {
+        _sync(hitpoints, id, f & Actor::Health);
+        _sync(collider, id, f & Actor::Collider);
+        _sync(input, id, f & Actor::Input);
+        _sync(timer, id, f & Actor::Timer);
+        _sync(parent, id, f & Actor::Child);
+        _sync(trail, id, f & Actor::Trail);
+    }
+
+    void move(EntityId from, EntityId to)
+    {
+        position.move(from, to);
+        speed.move(from, to);
+        hitpoints.move(from, to);
+        collider.move(from, to);
+        input.move(from, to);
+        text.move(from, to);
+        timer.move(from, to);
+        parent.move(from, to);
+        trail.move(from, to);
+    }
+
+    void clear()
+    {
+        hitpoints.clear();
+        collider.clear();
+        input.clear();
+        timer.clear();
+        parent.clear();
+        trail.clear();
+    }
+
+protected:
+    template <typename S>
+    static void _sync(S& storage, EntityId id, bool has)
+    {
+        if (has)
+            storage.add(id);
+        else
+            storage.remove(id);
+    }
+};
+
+using Components = ComponentsT<>;
+
+/// Flag mask required by a list of component types of 'Cs' (a ComponentsT)
+template <typename Cs, typename... C>
+struct ComponentFlags;
+
+template <typename Cs>
+struct ComponentFlags<Cs> {
+    static constexpr ActorFlags value { 0 };
+};
+
+template <typename Cs, typename C, typename... Rest>
+struct ComponentFlags<Cs, C, Rest...> {
+    static constexpr ActorFlags value { ActorFlags(Cs::flagOf(static_cast<C*>(nullptr)) | ComponentFlags<Cs, Rest...>::value) };
+};
+
+// --------------------------------------------------------------------------------
+// Scene tables
+
+/// Parts of a SceneActor, each setter replaces one part and keeps the others
+struct _SceneTag { uint8_t tag; };
+struct _ScenePosition { int8_t x, y; };
+struct _SceneText { const char *line0, *line1; };
+struct _SceneSpeed { int8_t vx, vy; };
+struct _SceneHitpoints { int8_t hp; };
+struct _SceneCollider {
+    int8_t colliderValue;
+    ColliderFn colliderFn;
+    uint8_t layer, mask;
+};
+struct _SceneInput { InputFn inputFn; };
+struct _SceneTimer {
+    uint8_t frameCount;
+    TimerFn timerFn;
+};
+struct _SceneTrail {
+    uint8_t trailLength;
+    const char *trailSymbol;
+};
+struct _SceneGroups { GroupMask groups; };
+
+/// One actor of a constant scene table, loaded by Engine::loadScene()
+/// e.g. constexpr SceneActor level[] RW_PROGMEM = { SceneActor(Actor::Move).text("@").position(1, 0) };
+/// NB: setters mirror ActorBuilder, callbacks must be named functions (lambdas are not constexpr in C++11)
+/// NB: a new field goes into a part (or a new part listed in both constructors), setters are not touched
+struct SceneActor : _SceneTag, _ScenePosition, _SceneText, _SceneSpeed, _SceneHitpoints,
+                    _SceneCollider, _SceneInput, _SceneTimer, _SceneTrail, _SceneGroups {
+    static constexpr uint8_t NoTag { 0xFF };
+
+    ActorFlags flags;
+
+    constexpr SceneActor(ActorFlags f = 0)
+        : _SceneTag { NoTag }, _ScenePosition { 0, 0 }, _SceneText { nullptr, nullptr }, _SceneSpeed { 0, 0 },
+          _SceneHitpoints { 0 }, _SceneCollider { 0, nullptr, 0, 0xFF }, _SceneInput { nullptr },
+          _SceneTimer { 0, nullptr }, _SceneTrail { 0, nullptr }, _SceneGroups { 0 }, flags(f)
+    {
+    }
+
+    constexpr SceneActor position(int8_t px, int8_t py) const { return with(flags, _ScenePosition { px, py }); }
+    constexpr SceneActor text(const char *l0, const char *l1 = nullptr) const { return with(flags | Actor::Text, _SceneText { l0, l1 }); }
+    constexpr SceneActor control() const { return with(flags | Actor::Control); }
+    constexpr SceneActor speed(int8_t svx, int8_t svy, bool noFlag = false) const
+    {
+        return with(noFlag ? flags : ActorFlags(flags | Actor::Move), _SceneSpeed { svx, svy });
+    }
+    constexpr SceneActor hitpoints(int8_t h) const { return with(flags | Actor::Health, _SceneHitpoints { h }); }
+    constexpr SceneActor collider(int8_t value, ColliderFn fn, uint8_t l = 0, uint8_t m = 0xFF) const
+    {
+        return with(flags | Actor::Collider, _SceneCollider { value, fn, uint8_t(l & 7), m });
+    }
+    constexpr SceneActor input(InputFn fn) const { return with(flags | Actor::Input, _SceneInput { fn }); }
+    constexpr SceneActor timer(uint8_t count, TimerFn fn) const { return with(flags | Actor::Timer, _SceneTimer { count, fn }); }
+    constexpr SceneActor trail(uint8_t length, const char *symbol) const { return with(flags | Actor::Trail, _SceneTrail { length, symbol }); }
+    constexpr SceneActor group(uint8_t g) const { return with(flags, _SceneGroups { GroupMask(groups | (GroupMask(1) << g)) }); }
+    constexpr SceneActor withTag(uint8_t t) const { return with(flags, _SceneTag { t }); }
+
+protected:
+    /// Copy with 'f' as flags and 'part' (one of the _Scene* parts) replaced
+    template <typename Part>
+    constexpr SceneActor with(ActorFlags f, const Part& part) const { return SceneActor(*this, f, part); }
+    constexpr SceneActor with(ActorFlags f) const { return SceneActor(*this, f, f); }
+
+    template <typename Part>
+    constexpr SceneActor(const SceneActor& a, ActorFlags f, const Part& p)
+        : _SceneTag(_part<_SceneTag>(a, p, 0)), _ScenePosition(_part<_ScenePosition>(a, p, 0)), _SceneText(_part<_SceneText>(a, p, 0)),
+          _SceneSpeed(_part<_SceneSpeed>(a, p, 0)), _SceneHitpoints(_part<_SceneHitpoints>(a, p, 0)),
+          _SceneCollider(_part<_SceneCollider>(a, p, 0)), _SceneInput(_part<_SceneInput>(a, p, 0)),
+          _SceneTimer(_part<_SceneTimer>(a, p, 0)), _SceneTrail(_part<_SceneTrail>(a, p, 0)),
+          _SceneGroups(_part<_SceneGroups>(a, p, 0)), flags(f)
+    {
+    }
+
+    /// The part B: 'p' when it is one, else the one of 'a' (the int overload wins when both match)
+    template <typename B>
+    static constexpr const B& _part(const SceneActor&, const B& p, int) { return p; }
+    template <typename B, typename P>
+    static constexpr const B& _part(const SceneActor& a, const P&, long) { return a; }
 };
 
 // --------------------------------------------------------------------------------
@@ -339,7 +987,9 @@ struct CustomCharacter {
     }
 };
 
-struct DrawContext {
+/// Screen buffer sized by Config, see Setup
+template <typename Config = Setup>
+struct DrawContextT {
     void* ctx { nullptr };
 
     void (*peerClearAll)(void *ctx){+[](void *) {
@@ -353,21 +1003,48 @@ struct DrawContext {
     void (*peerAddChar)(void *ctx, int8_t x, int8_t y, const uint8_t id){
         +[](void *ctx, int8_t x, int8_t y, const uint8_t id) {}};
 
+    /// Changed run of the buffer since the last presented frame, called at the end of a frame
+    /// NB: txt points into the buffer and is not terminated at len
+    void (*peerUpdateText)(void *ctx, int8_t x, int8_t y, const char *txt, uint8_t len){
+        +[](void *, int8_t, int8_t, const char *, uint8_t) {}};
+
     /// NB: must be set by 'frontend', is '8' for LiquidCrystal library
     uint8_t customCharacters { 0 };
 
     /// NB: extra flag
     bool disableDirectBufferDraw { false };
 
+#if RW_SETUP_PROFILE
+    /// peer function calls, collected by Engine::profile each frame
+    uint32_t peerCalls { 0 };
+#define _RW_PROFILE_PEER_CALL() peerCalls++
+#else
+#define _RW_PROFILE_PEER_CALL()
+#endif
+
     /// NB: buffer is directly accessible for simple 'frontend'
-    char buffer[Setup::ScreenHeight][Setup::ScreenWidth + 2];
+    char buffer[Config::ScreenHeight][Config::ScreenWidth + 2];
+
+    /// Changed cells of the last frame, bit (x % 16) of updateFlags[y][x / 16]
+    uint16_t updateFlags[Config::ScreenHeight][(Config::ScreenWidth + 15) / 16] {};
+
+    bool isUpdated(int8_t x, int8_t y) const { return (updateFlags[y][x / 16] >> (x % 16)) & 1; }
+
+    /// Repaint the whole buffer at the end of the next frame
+    void invalidate() { _presentedValid = false; }
 
-    uint16_t updateFlags[Setup::ScreenWidth / 16][Setup::ScreenHeight] {};
+protected:
+    /// Buffer as it was sent to peerUpdateText
+    char _presented[Config::ScreenHeight][Config::ScreenWidth];
+    bool _presentedValid { false };
+
+public:
 
     void defineChar(uint8_t idx, const CustomCharacter c)
     {
         if (!ctx)
             return;
+        _RW_PROFILE_PEER_CALL();
         peerDefineChar(ctx, idx, c);
     }
 
@@ -375,24 +1052,29 @@ struct DrawContext {
     {
         if (!ctx)
             return;
+        _RW_PROFILE_PEER_CALL();
         peerAddChar(ctx, x, y, id);
     }
 
-    DrawContext()
+    DrawContextT()
     {
         clearAll();
     }
 
     void clearAll()
     {
-        if (ctx)
+        // NB: peer may clear the display
+        if (ctx) {
+            _RW_PROFILE_PEER_CALL();
             peerClearAll(ctx);
+            invalidate();
+        }
 
-        for (int y = 0; y < Setup::ScreenHeight; y++) {
-            for (int x = 0; x < Setup::ScreenWidth; x++) {
+        for (int y = 0; y < Config::ScreenHeight; y++) {
+            for (int x = 0; x < Config::ScreenWidth; x++) {
                 buffer[y][x] = ' ';
             }
-            buffer[y][Setup::ScreenWidth] = 0;
+            buffer[y][Config::ScreenWidth] = 0;
         }
     }
     void addText(int8_t x, int8_t y, const char* txt)
@@ -400,45 +1082,124 @@ struct DrawContext {
         if (!txt)
             return;
 
-        if (!Setup::MoveOutsideScreen) {
+        addText(x, y, txt, strlen(txt));
+    }
+    /// Text with a known length, e.g. a line of the engine's text pool
+    void addText(int8_t x, int8_t y, const char* txt, size_t len)
+    {
+        if (!txt)
+            return;
+
+        if (!Config::MoveOutsideScreen) {
             if (x < 0)
                 x = 0;
-            if (x > Setup::LastSymbolX)
-                x = Setup::LastSymbolX;
+            if (x > Config::LastSymbolX)
+                x = Config::LastSymbolX;
             if (y < 0)
                 y = 0;
-            if (y > Setup::LastSymbolY)
-                y = Setup::LastSymbolY;
+            if (y > Config::LastSymbolY)
+                y = Config::LastSymbolY;
         }
 
-        size_t len = strlen(txt);
-        if (len > (Setup::ScreenWidth - x))
-            len = Setup::ScreenWidth - x;
+        if (len > size_t(Config::ScreenWidth - x))
+            len = Config::ScreenWidth - x;
 
         for (int i = 0; i < static_cast<int>(len); i++) {
             buffer[y][x + i] = txt[i];
         }
 
-        if (ctx)
+        if (ctx) {
+            _RW_PROFILE_PEER_CALL();
             peerAddText(ctx, x, y, txt);
+        }
     }
 
     void _begin()
     {
         // reset update flags
-        for (int x = 0; x < (Setup::ScreenWidth / 16); x++)
-            for (int y = 0; y < (Setup::ScreenHeight); y++)
-                updateFlags[x][y] = 0;
+        for (auto& row : updateFlags)
+            for (auto& f : row)
+                f = 0;
     }
     void _end()
     {
-        // TODO
-        // calculate elements to repaint
-        // call peer functions
+        // NB: frontend draws with peer functions directly, repaint the buffer when re-enabled
+        if (disableDirectBufferDraw) {
+            invalidate();
+            return;
+        }
+
+        for (int y = 0; y < Config::ScreenHeight; y++) {
+            // calculate elements to repaint
+            for (int x = 0; x < Config::ScreenWidth; x++) {
+                if (!_presentedValid || buffer[y][x] != _presented[y][x]) {
+                    updateFlags[y][x / 16] |= uint16_t(1) << (x % 16);
+                    _presented[y][x] = buffer[y][x];
+                }
+            }
+
+            // call peer functions for each changed run
+            int x = 0;
+            while (x < Config::ScreenWidth) {
+                if (x % 16 == 0 && !updateFlags[y][x / 16]) {
+                    x += 16;
+                    continue;
+                }
+                if (!isUpdated(x, y)) {
+                    x++;
+                    continue;
+                }
+
+                const int start = x;
+                while (x < Config::ScreenWidth && isUpdated(x, y))
+                    x++;
+
+                if (ctx) {
+                    _RW_PROFILE_PEER_CALL();
+                    peerUpdateText(ctx, start, y, &buffer[y][start], x - start);
+                }
+            }
+        }
+
+        _presentedValid = true;
     }
 };
 
-struct SharedData {
+using DrawContext = DrawContextT<>;
+
+/// Compile-time key of a typed shared value: T at the first aligned byte from 'Offset'
+/// e.g. using Score = SharedKey<uint16_t>; using Player = SharedKey<Snake *, Score::End>;
+/// NB: keys chained with ::End never overlap, check other layouts with SharedKeysApart
+template <typename T, uint16_t Offset = 0>
+struct SharedKey {
+    using Type = T;
+    static constexpr uint16_t Begin { (Offset + alignof(T) - 1) / alignof(T) * alignof(T) };
+    static constexpr uint16_t End { Begin + sizeof(T) };
+};
+
+/// true if the bytes of key K overlap none of the others
+template <typename K, typename... Others>
+struct _SharedKeyApart {
+    static constexpr bool value { true };
+};
+template <typename K, typename O, typename... Others>
+struct _SharedKeyApart<K, O, Others...> {
+    static constexpr bool value { (K::End <= O::Begin || O::End <= K::Begin) && _SharedKeyApart<K, Others...>::value };
+};
+
+/// true if no two keys share a byte, e.g. static_assert(SharedKeysApart<Score, Player>::value, "shared keys overlap");
+template <typename... Keys>
+struct SharedKeysApart {
+    static constexpr bool value { true };
+};
+template <typename K, typename... Keys>
+struct SharedKeysApart<K, Keys...> {
+    static constexpr bool value { _SharedKeyApart<K, Keys...>::value && SharedKeysApart<Keys...>::value };
+};
+
+/// Shared values sized by Config, see Setup
+template <typename Config = Setup>
+struct SharedDataT {
     union Element {
         uint8_t uint8[4];
         int8_t int8[4];
@@ -449,11 +1210,41 @@ struct SharedData {
         void* ptr;
     };
 
+    /// Budget of the typed values: RW_SETUP_SHARED_NUMBERS elements
+    static constexpr uint16_t Bytes { Config::SharedNumbers * sizeof(Element) };
+
 protected:
-    uint8_t _raw_bytes[Setup::SharedNumbers * sizeof(Element)];
+    alignas(Element) uint8_t _raw_bytes[Bytes];
+    /// Set bit == a typed value was created at this byte, see get()
+    BitSet<Bytes> _created;
 
 public:
-    const char* constStrings[Setup::SharedStrings];
+    const char* constStrings[Config::SharedStrings];
+
+    /// Typed value of a SharedKey by reference, e.g. ++RWE.sharedData.get<Score>();
+    /// NB: typed keys and element indices share the same bytes, use one or the other
+    /// NB: plain values only (numbers, pointers); the first call creates the T in the bytes, keeping their value
+    template <typename Key>
+    typename Key::Type& get()
+    {
+        using T = typename Key::Type;
+        static_assert(Key::End <= Bytes, "shared value exceeds RW_SETUP_SHARED_NUMBERS");
+        static_assert(alignof(T) <= alignof(Element), "shared value alignment");
+        void* p = &_raw_bytes[Key::Begin];
+        if (!_created.test(Key::Begin)) {
+            T value;
+            memcpy(&value, p, sizeof(T));
+            new (p) T(value);
+            _created.set(Key::Begin);
+        }
+        return *static_cast<T*>(p);
+    }
+
+    template <typename Key>
+    const typename Key::Type& get() const
+    {
+        return const_cast<SharedDataT*>(this)->template get<Key>();
+    }
 
     Element getElement(int index) const
     {
@@ -468,54 +1259,767 @@ public:
     }
 };
 
+using SharedData = SharedDataT<>;
+
+// --------------------------------------------------------------------------------
+// Profiling
+
+#if RW_SETUP_PROFILE
+
+#ifdef ARDUINO
+static inline uint32_t _ProfileClock()
+{
+    return micros();
+}
+#define _RW_PROFILE_TICKS_PER_SECOND 1000000UL
+#else
+static inline uint32_t _ProfileClock()
+{
+    using namespace std::chrono;
+    return uint32_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+#define _RW_PROFILE_TICKS_PER_SECOND 1000000000UL
+#endif
+
+/// Timing and counters of Engine::runLoop(), see Engine::profile
+struct Profile {
+    enum System : uint8_t { Input, Movement, Collision, Lifetime, Timer, Render, Present, SystemCount };
+
+    static const char *systemName(uint8_t s)
+    {
+        static const char *names[SystemCount]
+            = {"input", "movement", "collision", "lifetime", "timer", "render", "present"};
+        return s < SystemCount ? names[s] : "";
+    }
+
+    template <typename T>
+    struct Counters {
+        /// clock ticks per system
+        T ticks[SystemCount] {};
+
+        T actorsVisited {};
+        T colliderCalls {};
+        T textsDrawn {};
+        T peerCalls {};
+    };
+
+    /// Pluggable clock: micros() on Arduino, steady_clock nanoseconds on host
+    uint32_t (*clock)() { _ProfileClock };
+    uint32_t ticksPerSecond { _RW_PROFILE_TICKS_PER_SECOND };
+
+    /// last frame
+    Counters<uint32_t> frame {};
+
+    /// sums since reset()
+    Counters<uint64_t> total {};
+    uint32_t frames {};
+
+    void reset()
+    {
+        total = Counters<uint64_t>();
+        frames = 0;
+    }
+
+    void _beginFrame() { frame = Counters<uint32_t>(); }
+    void _endFrame()
+    {
+        for (int s = 0; s < SystemCount; s++)
+            total.ticks[s] += frame.ticks[s];
+        total.actorsVisited += frame.actorsVisited;
+        total.colliderCalls += frame.colliderCalls;
+        total.textsDrawn += frame.textsDrawn;
+        total.peerCalls += frame.peerCalls;
+        frames++;
+    }
+    /// Engine::present() after the frame ended
+    void _addPresent(uint32_t ticks, uint32_t peerCalls)
+    {
+        frame.ticks[Present] += ticks;
+        total.ticks[Present] += ticks;
+        frame.peerCalls += peerCalls;
+        total.peerCalls += peerCalls;
+    }
+};
+
+#define _RW_PROFILE_COUNT(counter, n) profile.frame.counter += (n)
+#define _RW_PROFILE_SYSTEM(system, ...) \
+    { \
+        const auto _t0 = profile.clock(); \
+        __VA_ARGS__; \
+        profile.frame.ticks[Profile::system] += profile.clock() - _t0; \
+    }
+
+#else
+
+#define _RW_PROFILE_COUNT(counter, n)
+#define _RW_PROFILE_SYSTEM(system, ...) __VA_ARGS__
+
+#endif
+
 // --------------------------------------------------------------------------------
 
-struct Engine {
+/// Engine for one screen / actor table, sized by Config (see Setup / SetupT)
+/// NB: RWE is the singleton of the default Engine = EngineT<Setup>
+template <typename Config = Setup>
+struct EngineT {
+    /// Setup of the engine, e.g. E::ConfigType::ScreenWidth in the helpers templated on the engine
+    using ConfigType = Config;
+
     using Tag = uint8_t;
+    /// Index of a tag group, e.g. an enum of the game: enemies, bullets
+    using Group = uint8_t;
+
+    using Components = ComponentsT<Config>;
+    using DrawContext = DrawContextT<Config>;
+    using SharedData = SharedDataT<Config>;
+
+    using Position = typename Components::Position;
+    using Speed = typename Components::Speed;
+    using Hitpoints = typename Components::Hitpoints;
+    using Collider = typename Components::Collider;
+    using Input = typename Components::Input;
+    using Text = typename Components::Text;
+    using TextLine = typename Components::TextLine;
+    using Timer = typename Components::Timer;
+    using Parent = typename Components::Parent;
+    using Trail = typename Components::Trail;
 
 protected:
     Components _components {};
-    Actor _actors[Setup::Actors];
-    Tag _tags[Setup::Tags];
+    Actor _actors[Config::Actors];
+    EntityId _tags[Config::Tags];
+
+#if RW_SETUP_HANDLES
+    /// Incremented when a slot is freed
+    uint8_t _generation[Config::Actors] {};
+#endif
+
+    using ActorSet = BitSet<Config::Actors>;
+    using Word = typename ActorSet::Word;
+
+    /// Set bit == free slot, kept in sync by spawn / remove / lifetime / reset
+    ActorSet _freeSlots;
+    /// Actors per flag bit, systems only visit the set bits
+    ActorSet _withFlag[Actor::FlagCount];
+    /// One past the highest active id, systems stop here
+    uint16_t _activeEnd { 0 };
+
+    /// Registered by setPrefab(), kept by reset()
+    const SceneActor* _prefabs[Config::Prefabs] {};
+
+    static_assert(Config::TagGroups <= 8 * sizeof(GroupMask), "too many tag groups");
+    /// Members per tag group, cleared when the actor is removed
+    ActorSet _groups[Config::TagGroups > 0 ? Config::TagGroups : 1];
+    /// Groups skipped by the systems, see pauseGroup()
+    GroupMask _pausedGroups { 0 };
+
+    static constexpr uint16_t TextPoolSize { Actor::enabled(Actor::Text) ? Config::TextLines : 1 };
+    /// Lines of all Text components, each actor owns a run of them
+    TextLine _textPool[TextPoolSize];
+    /// Set bit == line owned by an actor
+    BitSet<TextPoolSize> _textUsed;
+
+    /// First of 'n' free consecutive lines of the pool or TextPoolSize if none
+    uint16_t _findTextRun(uint8_t n, uint16_t from = 0) const
+    {
+        uint16_t run = 0;
+        for (uint16_t i = from; i < TextPoolSize; i++) {
+            run = _textUsed.test(i) ? 0 : run + 1;
+            if (run == n)
+                return i + 1 - n;
+        }
+        return TextPoolSize;
+    }
+
+    /// Moves the runs to the front of the pool in pool order, the free lines end up in one run
+    /// NB: O(actors * runs), only done when no run of free lines fits
+    void _packText()
+    {
+        uint16_t end = 0;
+        for (;;) {
+            // next run at or after 'end', including the ones of slots reserved by deferred spawns
+            uint16_t next = Config::Actors;
+            for (uint16_t i = 0; i < Config::Actors; i++) {
+                const auto& t = getText(EntityId(i));
+                if (t.count && t.first >= end && (next == Config::Actors || t.first < getText(EntityId(next)).first))
+                    next = i;
+            }
+            if (next == Config::Actors)
+                break;
+
+            auto& t = getText(EntityId(next));
+            for (uint8_t y = 0; y < t.count; y++)
+                _textPool[end + y] = _textPool[t.first + y];
+            t.first = end;
+            end += t.count;
+        }
+
+        _textUsed.clearAll();
+        for (uint16_t i = 0; i < end; i++)
+            _textUsed.set(i);
+    }
+
+    /// First of 'n' free consecutive lines, the pool is packed if they are free but split by other runs
+    uint16_t _allocTextRun(uint8_t n)
+    {
+        const uint16_t first = _findTextRun(n);
+        if (first < TextPoolSize || TextPoolSize - _textUsed.count() < n)
+            return first;
+        _packText();
+        return _findTextRun(n);
+    }
+
+    /// Returns the lines of actor 'id' to the pool
+    void _releaseText(EntityId id)
+    {
+        if (!Actor::enabled(Actor::Text))
+            return;
+
+        auto& t = getText(id);
+        for (uint8_t y = 0; y < t.count; y++)
+            _textUsed.reset(t.first + y);
+        t = Text();
+    }
+
+    /// Replaces the lines of actor 'id' with 'lines[0..n-1]', trailing nullptr lines are not stored
+    /// NB: false if the pool has no run of free lines, the actor has no text then
+    bool _setText(EntityId id, const char* const* lines, uint8_t n)
+    {
+        _releaseText(id);
+        while (n && !lines[n - 1])
+            n--;
+        if (!n || !Actor::enabled(Actor::Text))
+            return true;
+
+        const uint16_t first = _allocTextRun(n);
+        if (first == TextPoolSize)
+            return false;
+
+        auto& t = getText(id);
+        t.first = first;
+        t.count = n;
+        for (uint8_t y = 0; y < n; y++) {
+            _textUsed.set(first + y);
+            _textPool[first + y] = _measuredLine(lines[y]);
+        }
+        return true;
+    }
+
+    static TextLine _measuredLine(const char* text)
+    {
+        TextLine ret;
+        ret.text = text;
+        if (text) {
+            const size_t len = strlen(text);
+            ret.length = len < 0xFF ? len : 0xFF;
+        }
+        return ret;
+    }
+
+    void _joinGroups(EntityId id, GroupMask groups)
+    {
+        for (uint8_t g = 0; g < Config::TagGroups; g++)
+            if ((groups >> g) & 1)
+                _groups[g].set(id);
+    }
+
+    /// Word 'w' of actors in paused groups
+    Word _wordPaused(uint16_t w) const
+    {
+        Word ret = 0;
+        for (uint8_t g = 0; g < Config::TagGroups; g++)
+            if ((_pausedGroups >> g) & 1)
+                ret |= _groups[g].words[w];
+        return ret;
+    }
+
+    /// Children of a removed actor lose their parent, a later actor in its slot does not adopt them
+    void _unlinkChildren(EntityId id)
+    {
+        if (Actor::enabled(Actor::Child))
+            _forEachWithAny(Actor::Child, [this, id](EntityId c) {
+                auto& p = _components.parent[c];
+                if (p.id == id)
+                    p.id = Config::Actors;
+            });
+    }
+
+    void _setFlags(EntityId id, ActorFlags f)
+    {
+        f &= Actor::Features;
+        if (!(f & Actor::Text))
+            _releaseText(id);
+
+        for (uint8_t b = 0; b < Actor::FlagCount; b++) {
+            if ((f >> b) & 1)
+                _withFlag[b].set(id);
+            else
+                _withFlag[b].reset(id);
+        }
+
+#if RW_SETUP_HANDLES
+        if (!f && _actors[id].flags)
+            _generation[id]++;
+#endif
+        _actors[id].flags = f;
+        _components.sync(id, f);
+        if (f) {
+            _freeSlots.reset(id);
+            if (id >= _activeEnd)
+                _activeEnd = id + 1;
+        } else {
+            _freeSlots.set(id);
+            for (uint8_t g = 0; g < Config::TagGroups; g++)
+                _groups[g].reset(id);
+            _unlinkChildren(id);
+            while (_activeEnd && !_actors[_activeEnd - 1].flags)
+                _activeEnd--;
+        }
+    }
+
+    /// Writes a scene entry to the free slot 'id', false if a sparse storage or the text pool is full
+    bool _loadActor(EntityId id, const SceneActor& a)
+    {
+        const ActorFlags f = a.flags & Actor::Features;
+        if (!_components.hasRoom(id, f))
+            return false;
+        if (!f)
+            return true;
+#if RW_SETUP_COMMAND_BUFFER
+        if (_deferring && !_canDefer())
+            return false;
+#endif
+
+        const char* lines[2] = { a.line0, a.line1 };
+        if ((f & Actor::Text) && !_setText(id, lines, Config::ScreenHeight > 1 ? 2 : 1))
+            return false;
+
+        // NB: members are visited once active, so joining before a deferred spawn is fine
+        _joinGroups(id, a.groups);
+
+#if RW_SETUP_COMMAND_BUFFER
+        // reserve the slot now, systems see the actor after the sync point
+        if (_deferring) {
+            _freeSlots.reset(id);
+            _components.sync(id, f);
+            _defer(Command { Command::Spawn, id, f, a.tag != SceneActor::NoTag, a.tag });
+        } else
+#endif
+        {
+            _actors[id].flags = f;
+            _components.sync(id, f);
+            for (uint8_t b = 0; b < Actor::FlagCount; b++)
+                if ((f >> b) & 1)
+                    _withFlag[b].set(id);
+            _freeSlots.reset(id);
+            if (id >= _activeEnd)
+                _activeEnd = id + 1;
+            if (a.tag != SceneActor::NoTag)
+                setTag(id, a.tag);
+        }
+
+        auto& p = _components.position[id];
+        p = Position();
+        p.x = a.x;
+        p.y = a.y;
+
+        // NB: getters write to the dummy if the component is not stored
+        auto& s = getSpeed(id);
+        s = Speed();
+        s.vx = a.vx;
+        s.vy = a.vy;
+
+        getHitpoints(id).hp = a.hp;
+
+        auto& c = getCollider(id);
+        c.value = a.colliderValue;
+        c.colliderFn = a.colliderFn;
+        c.layer = a.layer;
+        c.mask = a.mask;
+
+        getInput(id).inputFn = a.inputFn;
+        getParent(id) = Parent();
+
+        auto& tm = getTimer(id);
+        tm.currentFrame = 0;
+        tm.frameCount = a.frameCount;
+        tm.fn = a.timerFn;
+
+        auto& tr = getTrail(id);
+        tr.clear();
+        tr.length = a.trailLength;
+        tr.symbol = a.trailSymbol;
+
+        return true;
+    }
+
+    /// Moves actor 'from' with its components and tags to the free slot 'to'
+    void _moveActor(EntityId from, EntityId to)
+    {
+        _components.move(from, to);
+
+        for (auto& t : _tags)
+            if (t == from)
+                t = to;
+
+        if (Actor::enabled(Actor::Child))
+            _forEachWithAny(Actor::Child, [this, from, to](EntityId c) {
+                auto& p = _components.parent[c];
+                if (p.id == from)
+                    p.id = to;
+            });
+
+        for (uint8_t g = 0; g < Config::TagGroups; g++)
+            if (_groups[g].test(from))
+                _groups[g].set(to);
+
+        // NB: the text lines moved with the component
+        getText(from) = Text();
+
+        _setFlags(to, _actors[from].flags);
+        _setFlags(from, 0);
+    }
+
+#if RW_SETUP_COLLISION_BROADPHASE
+    /// Broadphase grid: colliders per screen cell as linked lists in descending id order
+    /// NB: Config::Actors marks the end of a list
+    EntityId _cellHead[Config::ScreenWidth * Config::ScreenHeight];
+    EntityId _cellNext[Config::Actors];
+
+    /// Cell of a position, positions outside the screen are clamped to the border cells
+    static uint16_t _cellIndex(int8_t x, int8_t y)
+    {
+        if (x < 0)
+            x = 0;
+        if (x > Config::LastSymbolX)
+            x = Config::LastSymbolX;
+        if (y < 0)
+            y = 0;
+        if (y > Config::LastSymbolY)
+            y = Config::LastSymbolY;
+        return uint16_t(y) * Config::ScreenWidth + x;
+    }
+
+    void _buildCollisionGrid()
+    {
+        for (auto& c : _cellHead)
+            c = Config::Actors;
+
+        _forEachWithAny(Actor::Collider, [this](EntityId i) {
+            const auto& p = _components.position[i];
+            const auto cell = _cellIndex(p.x, p.y);
+            _cellNext[i] = _cellHead[cell];
+            _cellHead[cell] = i;
+        });
+    }
+#endif
+
+    /// Calls collider functions of both actors if their layers interact
+    /// Collider of an actor with the Collider flag, nullptr otherwise
+    Collider* _colliderOf(EntityId id)
+    {
+        return (_actors[id].flags & Actor::Collider) ? _components.collider.find(id) : nullptr;
+    }
+
+    void _collidePair(EntityId i, EntityId j)
+    {
+        // NB: colliders are looked up again after each callback, a callback may remove either actor
+        // and a sparse remove() moves another collider into the gap
+        auto ci = _colliderOf(i);
+        auto cj = _colliderOf(j);
+        if (!ci || !cj || !ci->interacts(*cj))
+            return;
+
+        _RW_PROFILE_COUNT(colliderCalls, 1);
+        if (ci->colliderFn)
+            ci->colliderFn(i, j);
+
+        // NB: 'j' is still called if 'i' removed itself, not after a reset
+        cj = _colliderOf(j);
+        if (!cj || _passStopped())
+            return;
+        _RW_PROFILE_COUNT(colliderCalls, 1);
+        if (cj->colliderFn)
+            cj->colliderFn(j, i);
+    }
+
+    /// Word 'w' of actors having any of the flags
+    Word _wordWithAny(ActorFlags flags, uint16_t w) const
+    {
+        Word ret = 0;
+        for (uint8_t b = 0; b < Actor::FlagCount; b++)
+            if ((flags >> b) & 1)
+                ret |= _withFlag[b].words[w];
+        return ret;
+    }
+
+    /// Word 'w' of active actors having all of the flags
+    /// NB: active = any flag set, reserved slots are not free but have no flags yet
+    Word _wordWithAll(ActorFlags flags, uint16_t w) const
+    {
+        auto ret = flags ? ActorSet::validBits(w) : _wordWithAny(ActorFlags(~0), w);
+        for (uint8_t b = 0; b < Actor::FlagCount; b++)
+            if ((flags >> b) & 1)
+                ret &= _withFlag[b].words[w];
+        return ret;
+    }
+
+    /// Calls fn(id) in ascending order for actors having any of the flags, starting at 'from'
+    /// NB: actors removed or spawned by fn past the current id are skipped / visited
+    template <typename Fn>
+    void _forEachWithAny(ActorFlags flags, Fn fn, uint16_t from = 0)
+    {
+        _forEachWord([this, flags](uint16_t w) { return _wordWithAny(flags, w); }, fn, from);
+    }
+
+    /// Same as _forEachWithAny() for actors having all of the flags, 0 visits every active actor
+    template <typename Fn>
+    void _forEachWithAll(ActorFlags flags, Fn fn, uint16_t from = 0)
+    {
+        _forEachWord([this, flags](uint16_t w) { return _wordWithAll(flags, w); }, fn, from);
+    }
+
+    /// _forEachWithAny() skipping actors of paused groups, used by the systems that update actors
+    template <typename Fn>
+    void _forEachRunning(ActorFlags flags, Fn fn)
+    {
+        _forEachWord([this, flags](uint16_t w) { return _wordWithAny(flags, w) & ~_wordPaused(w); }, fn, 0);
+    }
+
+    /// each<Components...>() skipping actors of paused groups
+    template <typename... C, typename Fn>
+    void _eachRunning(Fn fn)
+    {
+        _forEachWord([this](uint16_t w) { return _wordWithAll(ComponentFlags<Components, C...>::value, w) & ~_wordPaused(w); },
+                     [this, &fn](EntityId i) { fn(i, _components.storageOf(static_cast<C *>(nullptr))[i]...); }, 0);
+    }
+
+    /// true if the running system pass ends early, see reset()
+    bool _passStopped() const
+    {
+#if RW_SETUP_COMMAND_BUFFER
+        return _pendingReset;
+#else
+        return false;
+#endif
+    }
+
+    template <typename WordFn, typename Fn>
+    void _forEachWord(WordFn word, Fn fn, uint16_t from)
+    {
+        // NB: _activeEnd is re-read, fn may spawn past it
+        for (uint16_t w = from / ActorSet::WordBits; w * ActorSet::WordBits < _activeEnd; w++) {
+            auto mask = ~Word(0);
+            if (w == from / ActorSet::WordBits)
+                mask = ~((Word(1) << (from % ActorSet::WordBits)) - 1);
+
+            auto bits = word(w) & mask;
+            while (bits) {
+                const auto b = _CountTrailingZeros(bits);
+                _RW_PROFILE_COUNT(actorsVisited, 1);
+                fn(EntityId(w * ActorSet::WordBits + b));
+                if (_passStopped())
+                    return;
+                bits = word(w) & ~((Word(2) << b) - 1);
+            }
+        }
+    }
+
+#if RW_SETUP_COMMAND_BUFFER
+    /// Structural change recorded by a system, applied in order by _applyCommands()
+    /// NB: a reset is not a command, see _pendingReset
+    struct Command {
+        enum Type : uint8_t { Spawn, Remove };
+
+        uint8_t type;
+        EntityId id;
+        ActorFlags flags;
+        bool hasTag;
+        Tag tag;
+    };
+
+    Command _commands[Config::CommandBuffer];
+    uint8_t _commandCount { 0 };
+    /// true while runLoop() systems run
+    bool _deferring { false };
+    /// reset() was called by a system: the rest of its pass is skipped, applied first at the sync point
+    bool _pendingReset { false };
+
+    /// true if a command can be recorded now
+    bool _canDefer() const { return _commandCount < Config::CommandBuffer; }
+
+    /// Records the command if systems are running, false if it is to be applied now
+    /// NB: callers check _canDefer() first, the buffer is never applied mid-pass
+    bool _defer(const Command& c)
+    {
+        if (!_deferring)
+            return false;
+
+        _commands[_commandCount++] = c;
+        return true;
+    }
+
+    /// Drops the recorded commands, slots reserved by their spawns are freed
+    void _dropCommands()
+    {
+        for (uint8_t i = 0; i < _commandCount; i++)
+            if (_commands[i].type == Command::Spawn)
+                _setFlags(_commands[i].id, 0);
+        _commandCount = 0;
+    }
+
+#endif
+
+    /// Removes every actor and clears tags, paused groups and the scroll, see reset()
+    /// NB: slots reserved by spawns recorded after a deferred reset are kept
+    void _reset()
+    {
+        bool reserved = false;
+#if RW_SETUP_COMMAND_BUFFER
+        for (uint8_t i = 0; i < _commandCount; i++)
+            reserved |= _commands[i].type == Command::Spawn;
+#endif
+        if (reserved) {
+            // actor by actor, the components of the reserved slots stay
+            for (uint16_t i = _activeEnd; i > 0; i--)
+                if (_actors[i - 1].flags)
+                    _setFlags(i - 1, 0);
+        } else {
+            for (int i = 0; i < Config::Actors; i++) {
+#if RW_SETUP_HANDLES
+                if (_actors[i].flags)
+                    _generation[i]++;
+#endif
+                _actors[i].flags = 0;
+            }
+            _freeSlots.setAll();
+            for (auto& f : _withFlag)
+                f.clearAll();
+            for (auto& g : _groups)
+                g.clearAll();
+            _activeEnd = 0;
+            _components.clear();
+            for (int i = 0; i < Config::Actors; i++)
+                getText(i) = Text();
+            _textUsed.clearAll();
+        }
+
+        for (int i = 0; i < Config::Tags; i++)
+            _tags[i] = 0;
+        _pausedGroups = 0;
+        viewportScroll = ViewportScroll();
+    }
+
+    /// Sync point: applies a pending reset, then the recorded spawn / remove commands in order
+    void _applyCommands()
+    {
+#if RW_SETUP_COMMAND_BUFFER
+        const bool deferring = _deferring;
+        _deferring = false;
+
+        if (_pendingReset) {
+            _pendingReset = false;
+            _reset();
+        }
+        for (uint8_t i = 0; i < _commandCount; i++) {
+            const auto& c = _commands[i];
+            switch (c.type) {
+            case Command::Spawn:
+                _setFlags(c.id, c.flags);
+                if (c.hasTag)
+                    setTag(c.id, c.tag);
+                break;
+            case Command::Remove:
+                _setFlags(c.id, 0);
+                break;
+            }
+        }
+        _commandCount = 0;
+
+        _deferring = deferring;
+#endif
+    }
 
     /// Dummy value storage
     union DummyValues {
         Actor actor;
 
-        Components::Position _position;
-        Components::Speed _speed;
-        Components::Hitpoints _hitpoints;
-        Components::Collider _collider;
-        Components::Text _text;
-        Components::Input _input;
-        Components::Timer _timer;
+        Position _position;
+        Speed _speed;
+        Hitpoints _hitpoints;
+        Collider _collider;
+        Text _text;
+        Input _input;
+        Timer _timer;
+        Parent _parent;
+        Trail _trail;
 
         DummyValues() {}
     };
     static DummyValues _dummyValues;
 
 public:
+/// Builder methods are templates on their feature, so only calls to disabled ones fail
+#define _RW_BUILDER_FEATURE(flags) template <ActorFlags _Feature = (flags)>
+#define _RW_ASSERT_FEATURE() \
+    static_assert(Actor::enabled(_Feature), "component disabled by RW_SETUP_FEATURES")
+
     struct ActorBuilder {
-        Engine& _obj;
+        EngineT& _obj;
         ActorFlags _flags;
-        Optional<Engine::Tag> _tag { Optional<Engine::Tag>::Nullopt() };
+        Optional<EngineT::Tag> _tag { Optional<EngineT::Tag>::Nullopt() };
+        GroupMask _groups { 0 };
 
     protected:
-        friend class Engine;
-        ActorBuilder(Engine& e, ActorFlags f)
+        friend EngineT;
+        ActorBuilder(EngineT& e, ActorFlags f)
             : _obj(e)
             , _flags(f)
         {
         }
 
+        /// Bits of the components set by the builder methods
+        static constexpr uint8_t SpeedSet { 0x1 << 0 };
+        static constexpr uint8_t HitpointsSet { 0x1 << 1 };
+        static constexpr uint8_t ColliderSet { 0x1 << 2 };
+        static constexpr uint8_t TextSet { 0x1 << 3 };
+        static constexpr uint8_t InputSet { 0x1 << 4 };
+        static constexpr uint8_t TimerSet { 0x1 << 5 };
+        static constexpr uint8_t ParentSet { 0x1 << 6 };
+        static constexpr uint8_t TrailSet { 0x1 << 7 };
+
+        /// Components used by the systems of flags 'f'
+        static constexpr uint8_t componentsOf(ActorFlags f)
+        {
+            return ((f & (Actor::Move | Actor::Control)) ? SpeedSet : 0) | ((f & Actor::Health) ? HitpointsSet : 0)
+                | ((f & Actor::Collider) ? ColliderSet : 0) | ((f & Actor::Text) ? TextSet : 0)
+                | ((f & Actor::Input) ? InputSet : 0) | ((f & Actor::Timer) ? TimerSet : 0)
+                | ((f & Actor::Child) ? ParentSet : 0) | ((f & Actor::Trail) ? TrailSet : 0);
+        }
+
+        uint8_t _touched { 0 };
+
         //
-        Components::Position _position;
-        Components::Speed _speed;
-        Components::Hitpoints _hitpoints;
-        Components::Collider _collider;
-        Components::Text _text;
-        Components::Input _input;
-        Components::Timer _timer;
+        /// NB: stored in the text pool on spawn
+        struct Lines {
+            const char* line[Config::ScreenHeight] {};
+        };
+        /// NB: only the trail settings, the history starts empty
+        struct TrailSettings {
+            uint8_t length { 0 };
+            const char* symbol { nullptr };
+        };
+
+        // NB: values of disabled components take no space
+        Position _position;
+        _BuilderValue<Speed, Actor::enabled(Actor::Move | Actor::Control)> _speed;
+        _BuilderValue<Hitpoints, Actor::enabled(Actor::Health)> _hitpoints;
+        _BuilderValue<Collider, Actor::enabled(Actor::Collider)> _collider;
+        _BuilderValue<Lines, Actor::enabled(Actor::Text)> _lines;
+        _BuilderValue<Input, Actor::enabled(Actor::Input)> _input;
+        _BuilderValue<Timer, Actor::enabled(Actor::Timer)> _timer;
+        _BuilderValue<Parent, Actor::enabled(Actor::Child)> _parent;
+        _BuilderValue<TrailSettings, Config::MaxTrail && Actor::enabled(Actor::Trail)> _trail;
 
     public:
         ActorBuilder &position(int8_t x, int8_t y)
@@ -530,80 +2034,121 @@ public:
         ActorBuilder &randomPosition()
         {
             auto &p = _position;
-            p.x = rand() % Setup::ScreenWidth;
-            p.y = rand() % Setup::ScreenHeight;
+            p.x = rand() % Config::ScreenWidth;
+            p.y = rand() % Config::ScreenHeight;
             return *this;
         }
 
+        _RW_BUILDER_FEATURE(Actor::Text)
         ActorBuilder &text(const char *l0, const char *l1 = nullptr)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Text;
 
-            auto &p = _text;
-            p.line[0] = l0;
-            p.line[1] = l1;
+            _touched |= TextSet;
+
+            _lines.get().line[0] = l0;
+            if (Config::ScreenHeight > 1)
+                _lines.get().line[1] = l1;
             return *this;
         }
+        _RW_BUILDER_FEATURE(Actor::Text)
         ActorBuilder &textLine(const uint8_t line, const char *l0)
         {
-            if (line >= Setup::ScreenHeight)
+            _RW_ASSERT_FEATURE();
+
+            if (line >= Config::ScreenHeight)
                 return *this;
 
             _flags |= Actor::Text;
 
-            auto &p = _text;
+            _touched |= TextSet;
 
-            p.line[line] = l0;
+            _lines.get().line[line] = l0;
 
             return *this;
         }
+        _RW_BUILDER_FEATURE(Actor::Control)
         ActorBuilder &control()
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Control;
             return *this;
         }
+        _RW_BUILDER_FEATURE(Actor::Move | Actor::Control)
         ActorBuilder &speed(int8_t vx, int8_t vy, bool noFlag = false)
         {
+            _RW_ASSERT_FEATURE();
+
             if (!noFlag)
                 _flags |= Actor::Move;
 
-            auto& p = _speed;
+            _touched |= SpeedSet;
+
+            auto& p = _speed.get();
             p.vx = vx;
             p.vy = vy;
             return *this;
         }
+        _RW_BUILDER_FEATURE(Actor::Health)
         ActorBuilder &hitpoints(int8_t hp)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Health;
 
-            auto& p = _hitpoints;
+            _touched |= HitpointsSet;
+
+            auto& p = _hitpoints.get();
             p.hp = hp;
             return *this;
         }
 
-        ActorBuilder &collider(int8_t value, ColliderFn fn)
+        _RW_BUILDER_FEATURE(Actor::Collider)
+        ActorBuilder &collider(int8_t value,
+                               ColliderFn fn,
+                               uint8_t layer = 0,
+                               uint8_t mask = Collider::AllLayers)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Collider;
 
-            auto& p = _collider;
+            _touched |= ColliderSet;
+
+            auto& p = _collider.get();
             p.value = value;
             p.colliderFn = fn;
+            p.layer = layer & 7;
+            p.mask = mask;
             return *this;
         }
 
+        _RW_BUILDER_FEATURE(Actor::Input)
         ActorBuilder &input(InputFn fn)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Input;
 
-            auto &p = _input;
+            _touched |= InputSet;
+
+            auto &p = _input.get();
             p.inputFn = fn;
             return *this;
         }
+        _RW_BUILDER_FEATURE(Actor::Timer)
         ActorBuilder &timer(uint8_t count, TimerFn fn)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Timer;
 
-            auto& p = _timer;
+            _touched |= TimerSet;
+
+            auto& p = _timer.get();
             p.currentFrame = 0;
             p.frameCount = count;
             p.fn = fn;
@@ -611,23 +2156,67 @@ public:
         }
 
         /// Timer that runs each frame
+        _RW_BUILDER_FEATURE(Actor::Timer)
         ActorBuilder &eachFrame(TimerFn fn)
         {
+            _RW_ASSERT_FEATURE();
+
             _flags |= Actor::Timer;
 
-            auto &p = _timer;
+            _touched |= TimerSet;
+
+            auto &p = _timer.get();
             p.currentFrame = 0;
             p.frameCount = 0;
             p.fn = fn;
             return *this;
         }
 
+        /// Position follows actor 'id' at offset (dx, dy)
+        _RW_BUILDER_FEATURE(Actor::Child)
+        ActorBuilder &parent(EntityId id, int8_t dx, int8_t dy)
+        {
+            _RW_ASSERT_FEATURE();
+
+            _flags |= Actor::Child;
+
+            _touched |= ParentSet;
+            auto& p = _parent.get();
+            p.id = id;
+            p.dx = dx;
+            p.dy = dy;
+            return *this;
+        }
+
+        /// Draws 'symbol' at the last 'length' positions, e.g. a snake's body
+        _RW_BUILDER_FEATURE(Actor::Trail)
+        ActorBuilder &trail(uint8_t length, const char *symbol)
+        {
+            _RW_ASSERT_FEATURE();
+            static_assert(Config::MaxTrail > 0, "trails need RW_SETUP_MAX_TRAIL");
+
+            _flags |= Actor::Trail;
+
+            _touched |= TrailSet;
+            _trail.get().length = length;
+            _trail.get().symbol = symbol;
+            return *this;
+        }
+
         ActorBuilder &tag(Tag tag)
         {
             _tag = tag;
             return *this;
         }
 
+        /// Joins tag group 'g', may be called for several groups
+        ActorBuilder &group(Group g)
+        {
+            if (g < Config::TagGroups)
+                _groups |= GroupMask(1) << g;
+            return *this;
+        }
+
         //
 
         Optional<EntityId> spawn() const { return _obj._spawn(*this); }
@@ -641,30 +2230,56 @@ public:
     };
 
 protected:
-    Optional<EntityId> _spawn(ActorBuilder b)
+    Optional<EntityId> _spawn(const ActorBuilder& b)
     {
-        if (!canSpawn()) {
-            return Optional<EntityId>::Nullopt();
-        };
-
         auto optEntityId = getFreeEntityId();
         if (!optEntityId.has_value())
-            return 0;
+            return Optional<EntityId>::Nullopt();
 
         const auto& entityId = optEntityId.value();
+        if (!_components.hasRoom(entityId, b._flags))
+            return Optional<EntityId>::Nullopt();
+
+#if RW_SETUP_COMMAND_BUFFER
+        if (_deferring && b._flags && !_canDefer())
+            return Optional<EntityId>::Nullopt();
+#endif
+        // NB: components neither set nor used by the flags are reset, not copied from the builder
+        const uint8_t write = b._touched | ActorBuilder::componentsOf(b._flags);
+        if ((write & ActorBuilder::TextSet) && !_setText(entityId, b._lines.get().line, Config::ScreenHeight))
+            return Optional<EntityId>::Nullopt();
 
-        _actors[entityId].flags = b._flags;
+#if RW_SETUP_COMMAND_BUFFER
+        // reserve the slot now, systems see the actor after the sync point
+        if (_deferring && b._flags) {
+            _freeSlots.reset(entityId);
+            _components.sync(entityId, b._flags);
+            _defer(Command { Command::Spawn, entityId, b._flags, b._tag.has_value(), b._tag.has_value() ? b._tag.value() : Tag(0) });
+        } else
+#endif
+            // NB: actor with no flags keeps the slot free
+            _setFlags(entityId, b._flags);
 
+        // NB: the slot's previous actor must not leak into components added later by setFlags()
         getPosition(entityId) = b._position;
-        getSpeed(entityId) = b._speed;
-        getHitpoints(entityId) = b._hitpoints;
-        getCollider(entityId) = b._collider;
-        getText(entityId) = b._text;
-        getInput(entityId) = b._input;
-        getTimer(entityId) = b._timer;
+        getSpeed(entityId) = (write & ActorBuilder::SpeedSet) ? b._speed.get() : Speed();
+        getHitpoints(entityId) = (write & ActorBuilder::HitpointsSet) ? b._hitpoints.get() : Hitpoints();
+        getCollider(entityId) = (write & ActorBuilder::ColliderSet) ? b._collider.get() : Collider();
+        getInput(entityId) = (write & ActorBuilder::InputSet) ? b._input.get() : Input();
+        getTimer(entityId) = (write & ActorBuilder::TimerSet) ? b._timer.get() : Timer();
+        getParent(entityId) = (write & ActorBuilder::ParentSet) ? b._parent.get() : Parent();
+        if (write & ActorBuilder::TrailSet) {
+            auto& t = getTrail(entityId);
+            t.clear();
+            t.length = b._trail.get().length;
+            t.symbol = b._trail.get().symbol;
+        }
 
         if (b._tag.has_value())
             setTag(entityId, b._tag.value());
+        // NB: members are visited once active, so joining before a deferred spawn is fine
+        if (b._flags)
+            _joinGroups(entityId, b._groups);
 
         return entityId;
     }
@@ -681,73 +2296,143 @@ public:
     };
     ViewportScroll viewportScroll {};
 
+#if RW_SETUP_PROFILE
+    /// Filled by runLoop()
+    Profile profile {};
+#endif
+
+    /// NB: called from a system with RW_SETUP_COMMAND_BUFFER the reset is applied at the sync point,
+    /// commands recorded before it are dropped and no other callback of that system pass runs;
+    /// sparse components and text lines are released at once, so the actors spawned after it fit
     void reset()
     {
-        for (int i = 0; i < Setup::Actors; i++)
-            _actors[i].flags = 0;
-        for (int i = 0; i < Setup::Tags; i++)
-            _tags[i] = 0;
-
-        viewportScroll = ViewportScroll();
+#if RW_SETUP_COMMAND_BUFFER
+        if (_deferring) {
+            _dropCommands();
+            // NB: the actors keep their flags until the sync point, getters return the dummy values
+            for (uint16_t i = 0; i < _activeEnd; i++)
+                if (_actors[i].flags) {
+                    _components.sync(EntityId(i), 0);
+                    _releaseText(EntityId(i));
+                }
+            _pendingReset = true;
+            return;
+        }
+        _commandCount = 0;
+        _pendingReset = false;
+#endif
+        _reset();
     }
 
-    Engine() { reset(); }
+    EngineT() { reset(); }
 
-    Engine(const Engine &) = delete;
-    Engine &operator=(const Engine &) = delete;
+    EngineT(const EngineT &) = delete;
+    EngineT &operator=(const EngineT &) = delete;
 
     // ---
     // Component getters
-    // NB: returns dummy if id>= Setup::Actors
+    // NB: returns dummy if id>= Config::Actors
 
-    Components::Position &getPosition(EntityId id)
+    Position &getPosition(EntityId id)
     {
-        if (id >= Setup::Actors)
+        if (id >= Config::Actors)
             return _dummyValues._position;
         return _components.position[id];
     }
-    Components::Speed &getSpeed(EntityId id)
+    Speed &getSpeed(EntityId id)
+    {
+        auto p = id < Config::Actors ? _components.speed.find(id) : nullptr;
+        return p ? *p : _dummyValues._speed;
+    }
+    Hitpoints &getHitpoints(EntityId id)
+    {
+        auto p = id < Config::Actors ? _components.hitpoints.find(id) : nullptr;
+        return p ? *p : _dummyValues._hitpoints;
+    }
+
+    Collider &getCollider(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._speed;
-        return _components.speed[id];
+        auto p = id < Config::Actors ? _components.collider.find(id) : nullptr;
+        return p ? *p : _dummyValues._collider;
     }
-    Components::Hitpoints &getHitpoints(EntityId id)
+    Text &getText(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._hitpoints;
-        return _components.hitpoints[id];
+        auto p = id < Config::Actors ? _components.text.find(id) : nullptr;
+        return p ? *p : _dummyValues._text;
     }
 
-    Components::Collider &getCollider(EntityId id)
+    /// Sets line 'y' of the actor's text, the length is measured here and cached
+    /// NB: call again when the string changes, false for inactive actors, 'y' off screen or a full pool
+    bool setTextLine(EntityId id, uint8_t y, const char* text)
+    {
+        if (!Actor::enabled(Actor::Text) || !isActiveActor(id) || y >= Config::ScreenHeight)
+            return false;
+
+        auto& t = getText(id);
+        if (y < t.count) {
+            _textPool[t.first + y] = _measuredLine(text);
+            return true;
+        }
+        if (!text)
+            return true;
+
+        // grow in place if the lines after the run are free, move the run otherwise
+        const uint8_t n = y + 1;
+        if (t.count && t.first + n <= TextPoolSize && _findTextRun(n - t.count, t.first + t.count) == t.first + t.count) {
+            for (uint8_t i = t.count; i < n; i++) {
+                _textUsed.set(t.first + i);
+                _textPool[t.first + i] = TextLine();
+            }
+            t.count = n;
+        } else {
+            const uint16_t first = _allocTextRun(n);
+            if (first == TextPoolSize)
+                return false;
+            for (uint8_t i = 0; i < n; i++) {
+                _textUsed.set(first + i);
+                _textPool[first + i] = i < t.count ? _textPool[t.first + i] : TextLine();
+            }
+            for (uint8_t i = 0; i < t.count; i++)
+                _textUsed.reset(t.first + i);
+            t.first = first;
+            t.count = n;
+        }
+
+        _textPool[t.first + y] = _measuredLine(text);
+        return true;
+    }
+    const char* getTextLine(EntityId id, uint8_t y)
+    {
+        const auto& t = getText(id);
+        return Actor::enabled(Actor::Text) && y < t.count ? _textPool[t.first + y].text : nullptr;
+    }
+    /// Lines of the text pool owned by actors, see RW_SETUP_TEXT_LINES
+    uint16_t textLinesUsed() const { return _textUsed.count(); }
+    Input &getInput(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._collider;
-        return _components.collider[id];
+        auto p = id < Config::Actors ? _components.input.find(id) : nullptr;
+        return p ? *p : _dummyValues._input;
     }
-    Components::Text &getText(EntityId id)
+    Timer &getTimer(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._text;
-        return _components.text[id];
+        auto p = id < Config::Actors ? _components.timer.find(id) : nullptr;
+        return p ? *p : _dummyValues._timer;
     }
-    Components::Input &getInput(EntityId id)
+    Parent &getParent(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._input;
-        return _components.input[id];
+        auto p = id < Config::Actors ? _components.parent.find(id) : nullptr;
+        return p ? *p : _dummyValues._parent;
     }
-    Components::Timer &getTimer(EntityId id)
+    Trail &getTrail(EntityId id)
     {
-        if (id >= Setup::Actors)
-            return _dummyValues._timer;
-        return _components.timer[id];
+        auto p = id < Config::Actors ? _components.trail.find(id) : nullptr;
+        return p ? *p : _dummyValues._trail;
     }
 
     /// true if actor flags != 0
     bool isActiveActor(EntityId id)
     {
-        if (id >= Setup::Actors)
+        if (id >= Config::Actors)
             return false;
         return _actors[id].flags != 0;
     }
@@ -755,7 +2440,7 @@ public:
     // ---
     void setTag(EntityId id, Tag tag)
     {
-        if (tag >= Setup::Tags)
+        if (tag >= Config::Tags)
             return;
         _tags[tag] = id;
     }
@@ -765,7 +2450,7 @@ public:
     /// Get Actor by entity id, returns dummy if fails
     Actor &getActor(EntityId id)
     {
-        if (id >= Setup::Actors) {
+        if (id >= Config::Actors) {
             _dummyValues.actor.flags = 0;
             return _dummyValues.actor;
         }
@@ -774,7 +2459,7 @@ public:
 
     Actor &getActorByTag(const Tag tag)
     {
-        if (tag >= Setup::Tags) {
+        if (tag >= Config::Tags) {
             _dummyValues.actor.flags = 0;
             return _dummyValues.actor;
         }
@@ -784,30 +2469,91 @@ public:
 
     Optional<EntityId> getIdByTag(Tag tag)
     {
-        if (tag >= Setup::Tags)
+        if (tag >= Config::Tags)
             return Optional<EntityId>::Nullopt();
 
         return _tags[tag];
     }
 
-    /// find free id
-    bool canSpawn() const
+    // ---
+    // Tag groups: any number of actors per group, an actor may be in several groups
+    // NB: removed actors leave their groups
+
+    void joinGroup(EntityId id, Group g)
     {
-        for (auto& e : _actors)
-            if (e.flags == 0)
-                return true;
+        if (id >= Config::Actors || g >= Config::TagGroups || !_actors[id].flags)
+            return;
+        _groups[g].set(id);
+    }
+
+    void leaveGroup(EntityId id, Group g)
+    {
+        if (id >= Config::Actors || g >= Config::TagGroups)
+            return;
+        _groups[g].reset(id);
+    }
+
+    bool inGroup(EntityId id, Group g) const
+    {
+        if (id >= Config::Actors || g >= Config::TagGroups)
+            return false;
+        return _groups[g].test(id) && _actors[id].flags;
+    }
+
+    /// Calls fn(id) for the active members in id order, like each<>()
+    template <typename Fn>
+    void eachInGroup(Group g, Fn fn)
+    {
+        if (g >= Config::TagGroups)
+            return;
+        _forEachWord([this, g](uint16_t w) { return _groups[g].words[w] & _wordWithAll(0, w); }, fn, 0);
+    }
+
+    /// Number of active members
+    uint16_t groupCount(Group g) const
+    {
+        if (g >= Config::TagGroups)
+            return 0;
+        uint16_t ret = 0;
+        for (uint16_t w = 0; w * ActorSet::WordBits < _activeEnd; w++)
+            ret += _CountOnes(_groups[g].words[w] & _wordWithAll(0, w));
+        return ret;
+    }
 
+    /// true if any member is active, e.g. "any enemy alive"
+    bool groupAny(Group g) const
+    {
+        if (g >= Config::TagGroups)
+            return false;
+        for (uint16_t w = 0; w * ActorSet::WordBits < _activeEnd; w++)
+            if (_groups[g].words[w] & _wordWithAll(0, w))
+                return true;
         return false;
     }
 
-    Optional<EntityId> getFreeEntityId()
+    /// Members of paused groups are skipped by the input, movement, lifetime and timer systems
+    /// NB: they are still drawn and collide, cleared by reset()
+    void pauseGroup(Group g, bool paused = true)
     {
-        for (auto i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags == 0)
-                return i;
-        }
+        if (g >= Config::TagGroups)
+            return;
+        if (paused)
+            _pausedGroups |= GroupMask(1) << g;
+        else
+            _pausedGroups &= ~(GroupMask(1) << g);
+    }
+
+    /// true if there is a free slot
+    bool canSpawn() const { return _freeSlots.any(); }
+
+    /// Lowest free id
+    Optional<EntityId> getFreeEntityId() const
+    {
+        const auto i = _freeSlots.first();
+        if (i >= Config::Actors)
+            return Optional<EntityId>::Nullopt();
 
-        return Optional<EntityId>::Nullopt();
+        return EntityId(i);
     }
 
     // ---
@@ -815,197 +2561,496 @@ public:
     ActorBuilder make(ActorFlags f = 0) { return ActorBuilder { *this, f }; }
 
     /// Make a copy of Actor if it exists / is non-zero
+    /// NB: copies the position and the components used by its flags
     ActorBuilder clone(EntityId id)
     {
         if (!isActiveActor(id))
             return make();
 
         auto ret = ActorBuilder{*this, getActor(id).flags};
+        ret._touched = ActorBuilder::componentsOf(ret._flags);
+        for (uint8_t g = 0; g < Config::TagGroups; g++)
+            if (_groups[g].test(id))
+                ret._groups |= GroupMask(1) << g;
 
         ret._position = getPosition(id);
-        ret._speed = getSpeed(id);
-        ret._hitpoints = getHitpoints(id);
-
-        ret._collider = getCollider(id);
-        ret._text = getText(id);
-        ret._input = getInput(id);
-        ret._timer = getTimer(id);
+        if (ret._touched & ActorBuilder::SpeedSet)
+            ret._speed.get() = getSpeed(id);
+        if (ret._touched & ActorBuilder::HitpointsSet)
+            ret._hitpoints.get() = getHitpoints(id);
+
+        if (ret._touched & ActorBuilder::ColliderSet)
+            ret._collider.get() = getCollider(id);
+        if (ret._touched & ActorBuilder::TextSet)
+            for (uint8_t y = 0; y < getText(id).count; y++)
+                ret._lines.get().line[y] = _textPool[getText(id).first + y].text;
+        if (ret._touched & ActorBuilder::InputSet)
+            ret._input.get() = getInput(id);
+        if (ret._touched & ActorBuilder::TimerSet)
+            ret._timer.get() = getTimer(id);
+        if (ret._touched & ActorBuilder::ParentSet)
+            ret._parent.get() = getParent(id);
+        if (ret._touched & ActorBuilder::TrailSet) {
+            ret._trail.get().length = getTrail(id).length;
+            ret._trail.get().symbol = getTrail(id).symbol;
+        }
 
         return ret;
     }
 
     /// remove(Actor) : set class to zero @ entityId
-    void remove(EntityId id) { _actors[id].flags = 0; }
+    /// NB: removing a free slot is a no-op
+    /// NB: called from a system with RW_SETUP_COMMAND_BUFFER the actor stays active until the sync point,
+    /// false if the command buffer is full: the actor is not removed then
+    bool remove(EntityId id)
+    {
+        if (id >= Config::Actors)
+            return false;
+#if RW_SETUP_COMMAND_BUFFER
+        if (_deferring) {
+            // NB: removing an actor twice needs one command
+            for (uint8_t i = 0; i < _commandCount; i++)
+                if (_commands[i].type == Command::Remove && _commands[i].id == id)
+                    return true;
+            if (!_canDefer())
+                return false;
+        }
+        if (_defer(Command { Command::Remove, id, 0, false, 0 }))
+            return true;
+#endif
+
+        _setFlags(id, 0);
+        return true;
+    }
+
+    /// Calls fn(id, component&...) for every actor having all of the components, in id order
+    /// e.g. each<Components::Position, Components::Speed>([](EntityId id, Components::Position &p, Components::Speed &s) {});
+    /// NB: no bounds checks, fn may remove / spawn actors like in the systems
+    template <typename... C, typename Fn>
+    void each(Fn fn)
+    {
+        _forEachWithAll(ComponentFlags<Components, C...>::value,
+                        [this, &fn](EntityId i) { fn(i, _components.storageOf(static_cast<C *>(nullptr))[i]...); });
+    }
+
+    /// Calls fn(id) for every actor having all of the flags, e.g. each<Actor::Move | Actor::Collider>()
+    template <ActorFlags Flags, typename Fn>
+    void each(Fn fn)
+    {
+        _forEachWithAll(Flags, fn);
+    }
+
+    /// Handle of an actor slot, compare with isValid() later
+    Handle handle(EntityId id) const
+    {
+        Handle ret;
+        ret.id = id;
+#if RW_SETUP_HANDLES
+        if (id < Config::Actors)
+            ret.generation = _generation[id];
+#endif
+        return ret;
+    }
+
+    /// true if the actor of the handle was not removed since handle()
+    /// NB: without RW_SETUP_HANDLES only checks that the slot is active
+    bool isValid(Handle h) const
+    {
+        if (h.id >= Config::Actors || !_actors[h.id].flags)
+            return false;
+#if RW_SETUP_HANDLES
+        return _generation[h.id] == h.generation;
+#else
+        return true;
+#endif
+    }
+
+    /// One past the highest active id
+    uint16_t activeEnd() const { return _activeEnd; }
+
+    /// Called by compact() for every moved actor
+    using RemapFn = void (*)(EntityId from, EntityId to);
+
+    /// Moves active actors to the lowest ids keeping their order, tags, groups and parent links follow
+    /// NB: ids stored elsewhere by the game are stale after this, update them in 'remap'
+    void compact(RemapFn remap = nullptr)
+    {
+        EntityId to = 0;
+        for (uint16_t from = 0; from < _activeEnd; from++) {
+            if (!_actors[from].flags)
+                continue;
+
+            if (from != to) {
+                _moveActor(from, to);
+                if (remap)
+                    remap(from, to);
+            }
+            to++;
+        }
+    }
+
+    /// Change flags of an existing actor, false if a sparse component storage is full
+    /// NB: use this instead of writing getActor(id).flags so the systems see the change
+    /// NB: with sparse storage, components of cleared flags are dropped, new ones are default
+    bool setFlags(EntityId id, ActorFlags f)
+    {
+        if (id >= Config::Actors || !_components.hasRoom(id, f))
+            return false;
+
+        _setFlags(id, f);
+        return true;
+    }
+
+    /// Adds the actors of a scene table, entry i gets id activeEnd() + i while that slot is free,
+    /// the other entries go to the lowest free slots like spawn(); 'firstId' gets the id of entry 0
+    /// e.g. RWE.reset(); RWE.loadScene(level, sizeof(level) / sizeof(level[0]), &playerId);
+    /// NB: the table may be in flash, see RW_PROGMEM; entries without flags leave their slot free
+    /// NB: called from a system with RW_SETUP_COMMAND_BUFFER the entries are spawned like spawn() there
+    /// Returns the number of loaded entries, loading stops when actors, sparse storages or the buffer are full
+    uint16_t loadScene(const SceneActor* scene, uint16_t count, EntityId* firstId = nullptr)
+    {
+        // slots past _activeEnd are free unless reserved by a spawn of the running system
+        const uint16_t first = _activeEnd;
+        uint16_t n = 0;
+        for (; n < count; n++) {
+            // NB: lower slots freed by remove() are used once the ids past the first _activeEnd run out
+            const uint16_t id = first + n < Config::Actors && _freeSlots.test(first + n) ? first + n : _freeSlots.first();
+            if (id >= Config::Actors)
+                break;
+
+            SceneActor a;
+            _RW_READ_PROGMEM(&a, scene + n, sizeof(SceneActor));
+            if (!_loadActor(EntityId(id), a))
+                break;
+            if (!n && firstId)
+                *firstId = EntityId(id);
+        }
+        return n;
+    }
+
+    template <uint16_t N>
+    uint16_t loadScene(const SceneActor (&scene)[N], EntityId* firstId = nullptr)
+    {
+        return loadScene(scene, N, firstId);
+    }
+
+    /// Index of a registered prefab, e.g. an enum of the game
+    using Prefab = uint8_t;
+
+    /// Registers an actor template once, 'p' must outlive its use and may be in flash (RW_PROGMEM)
+    void setPrefab(Prefab prefab, const SceneActor* p)
+    {
+        if (prefab >= Config::Prefabs)
+            return;
+        _prefabs[prefab] = p;
+    }
+
+    /// Function form of the spawnMany() callback, 'index' counts from 0
+    using PositionFn = void (*)(uint16_t index, Position& p);
+
+    template <typename Fn>
+    static bool _isSet(const Fn&) { return true; }
+    static bool _isSet(PositionFn fn) { return fn != nullptr; }
+
+    /// Spawns up to 'count' copies of a prefab into the lowest free slots in one pass
+    /// Returns the number of spawned actors, 0 for unknown prefabs or prefabs without flags
+    uint16_t spawnMany(Prefab prefab, uint16_t count)
+    {
+        return spawnMany(prefab, count, PositionFn(nullptr));
+    }
+
+    /// spawnMany() calling positionFn(index, position) for every copy, any callable e.g. a capturing lambda
+    /// e.g. RWE.spawnMany(PREFAB_BULLET, 1, [shooter](uint16_t, Components::Position &p) { p = RWE.getPosition(shooter); });
+    /// NB: a null PositionFn keeps the prefab's position
+    template <typename Fn>
+    uint16_t spawnMany(Prefab prefab, uint16_t count, Fn positionFn)
+    {
+        if (prefab >= Config::Prefabs || !_prefabs[prefab])
+            return 0;
+
+        SceneActor a;
+        _RW_READ_PROGMEM(&a, _prefabs[prefab], sizeof(SceneActor));
+        if (!(a.flags & Actor::Features))
+            return 0;
+
+        uint16_t n = 0;
+        for (uint16_t w = 0; w < ActorSet::Words && n < count; w++) {
+            Word free = _freeSlots.words[w];
+            while (free && n < count) {
+                const EntityId id = EntityId(w * ActorSet::WordBits + _CountTrailingZeros(free));
+                free &= free - 1;
+
+                if (!_loadActor(id, a))
+                    return n;
+                if (_isSet(positionFn))
+                    positionFn(n, _components.position[id]);
+                n++;
+            }
+        }
+        return n;
+    }
 
     // --------------------------------------------------------------------------------
     // Systems
 
     void inputSystem()
     {
-        // iterate actors
-        // if class != 0
-        // if controllable
+        if (!Actor::enabled(Actor::Control | Actor::Input))
+            return;
+
+        // iterate actors with Control or Input
         // forward input
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                // control: change speed directly
-                if (_actors[i].flags & Actor::Control) {
-                    auto& p = getSpeed(i);
-                    if (rawInput.left)
-                        p.vx = -1;
-                    if (rawInput.right)
-                        p.vx = 1;
-                    if (rawInput.up)
-                        p.vy = -1;
-                    if (rawInput.down)
-                        p.vy = 1;
-
-                    if (!(rawInput.left || rawInput.right || rawInput.up || rawInput.down)) {
-                        p.vx = 0;
-                        p.vy = 0;
-                    }
+        _forEachRunning(Actor::Control | Actor::Input, [this](EntityId i) {
+            // control: change speed directly
+            if (_actors[i].flags & Actor::Control) {
+                auto& p = _components.speed[i];
+                if (rawInput.left)
+                    p.vx = -1;
+                if (rawInput.right)
+                    p.vx = 1;
+                if (rawInput.up)
+                    p.vy = -1;
+                if (rawInput.down)
+                    p.vy = 1;
+
+                if (!(rawInput.left || rawInput.right || rawInput.up || rawInput.down)) {
+                    p.vx = 0;
+                    p.vy = 0;
                 }
+            }
 
-                // input handler: forward
-                if (_actors[i].flags & Actor::Input) {
-                    getInput(i).inputFn(i, rawInput);
-                }
+            // input handler: forward
+            // NB: an input added by setFlags() has no function until one is set
+            if ((_actors[i].flags & Actor::Input) && _components.input[i].inputFn) {
+                _components.input[i].inputFn(i, rawInput);
             }
+        });
+    }
+
+    /// Sets the position, kept on screen unless Config::MoveOutsideScreen
+    static void _moveTo(Position& p, int16_t x, int16_t y)
+    {
+        // NB: currently limited by the setup
+        if (!Config::MoveOutsideScreen) {
+            if (x >= Config::ScreenWidth)
+                x = Config::LastSymbolX;
+            if (x < 0)
+                x = 0;
+            if (y >= Config::ScreenHeight)
+                y = Config::LastSymbolY;
+            if (y < 0)
+                y = 0;
         }
+        p.x = int8_t(x);
+        p.y = int8_t(y);
     }
 
     void movementSystem()
     {
-        // iterate actors
-        // if class != 0
-        // if moveable : += speed
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                if (_actors[i].flags & Actor::Move) {
-                    auto& p = _components.position[i];
-
-                    p.x = int8_t(p.x) + _components.speed[i].vx;
-                    p.y = int8_t(p.y) + _components.speed[i].vy;
-
-                    // NB: currently limited by the setup
-                    if (!Setup::MoveOutsideScreen) {
-                        if (p.x >= Setup::ScreenWidth)
-                            p.x = Setup::LastSymbolX;
-                        if (p.x < 0)
-                            p.x = 0;
-                        if (p.y >= Setup::ScreenHeight)
-                            p.y = Setup::LastSymbolY;
-                        if (p.y < 0)
-                            p.y = 0;
-                    }
-                }
+        if (!Actor::enabled(Actor::Move | Actor::Child | Actor::Trail))
+            return;
+
+        // iterate moveable actors : += speed
+        _eachRunning<Position, Speed>([](EntityId, Position& p, Speed& s) { _moveTo(p, p.x + s.vx, p.y + s.vy); });
+
+        // children: parent position + offsets summed up to the root, so id order does not matter
+        // NB: children of removed parents and of too deep chains keep their position
+        _forEachWithAny(Actor::Child, [this](EntityId i) {
+            int16_t x = 0, y = 0;
+            EntityId root = i;
+            for (uint8_t d = 0; d < Parent::MaxDepth && (_actors[root].flags & Actor::Child); d++) {
+                const auto& p = _components.parent[root];
+                x += p.dx;
+                y += p.dy;
+                root = p.id;
+                if (root >= Config::Actors)
+                    return;
             }
-        }
+            if (!_actors[root].flags || (_actors[root].flags & Actor::Child))
+                return;
+
+            const auto& r = _components.position[root];
+            _moveTo(_components.position[i], r.x + x, r.y + y);
+        });
+
+        // trails: one write per moved actor, whatever the length
+        _forEachWithAny(Actor::Trail, [this](EntityId i) {
+            auto& t = _components.trail[i];
+            const auto& p = _components.position[i];
+            if (t.firstAge(p) == 0)
+                t.push(p.x, p.y);
+        });
     }
 
     void collisionSystem()
     {
-        // iterate actors
-        // if class != 0
-        // if colliding:
-        //   iterate actors
-        //   if same pos: call onCollision on both
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                if (_actors[i].flags & Actor::Collider) {
-                    //
-                    for (int j = i + 1; j < Setup::Actors; j++) {
-                        if (_actors[j].flags != 0) {
-                            if (_actors[j].flags & Actor::Collider) {
-                                // call collider from components
-                                auto& p = getCollider(i);
-                                p.colliderFn(i, j);
-
-                                auto& p2 = getCollider(j);
-                                p2.colliderFn(j, i);
-                            }
-                        }
+        if (!Actor::enabled(Actor::Collider))
+            return;
+
+#if RW_SETUP_COLLISION_BROADPHASE
+        // put colliders into screen cells
+        // iterate colliding actors
+        //   iterate colliding actors after this one in the nearby cells
+        //   call collider functions on both
+        // NB: colliders spawned by collider functions join the grid on the next frame
+        _buildCollisionGrid();
+
+        _forEachWithAny(Actor::Collider, [this](EntityId i) {
+            constexpr int R = Config::CollisionNeighbourhood;
+            const auto& p = _components.position[i];
+            const auto cell = _cellIndex(p.x, p.y);
+            const int cx = cell % Config::ScreenWidth;
+            const int cy = cell / Config::ScreenWidth;
+
+            for (int y = cy - R; y <= cy + R; y++) {
+                if (y < 0 || y >= Config::ScreenHeight)
+                    continue;
+                for (int x = cx - R; x <= cx + R; x++) {
+                    if (x < 0 || x >= Config::ScreenWidth)
+                        continue;
+
+                    for (auto j = _cellHead[y * Config::ScreenWidth + x]; j < Config::Actors;
+                         j = _cellNext[j]) {
+                        if (j <= i || _passStopped())
+                            break;
+                        if (_actors[j].flags & Actor::Collider)
+                            _collidePair(i, j);
                     }
                 }
             }
-        }
+        });
+#else
+        // iterate colliding actors
+        //   iterate colliding actors after this one
+        //   call collider functions on both
+        _forEachWithAny(Actor::Collider, [this](EntityId i) {
+            _forEachWithAny(
+                Actor::Collider, [this, i](EntityId j) { _collidePair(i, j); }, i + 1);
+        });
+#endif
     }
 
     void lifetimeSystem()
     {
-        // iterate actors
-        // if class != 0
-        // if withhealth
-        // if hp == 0 : set class == 0
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                if (_actors[i].flags & Actor::Health) {
-                    if (_components.hitpoints[i].hp == 0) {
-                        _actors[i].flags = 0;
-                    }
-                }
-            }
-        }
+        if (!Actor::enabled(Actor::Health))
+            return;
+
+        // iterate actors with health
+        // if hp == 0 : remove
+        _eachRunning<Hitpoints>([this](EntityId i, Hitpoints& h) {
+            if (h.hp == 0)
+                remove(i);
+        });
     }
 
     void timerSystem()
     {
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                if (_actors[i].flags & Actor::Timer) {
-                    // timer fn here:
-                    auto& p = getTimer(i);
-                    p.currentFrame++;
-                    if (p.currentFrame >= p.frameCount) {
-                        p.currentFrame = 0;
-                        p.fn(i);
-                    }
-                }
+        if (!Actor::enabled(Actor::Timer))
+            return;
+
+        _eachRunning<Timer>([](EntityId i, Timer& p) {
+            // timer fn here:
+            p.currentFrame++;
+            if (p.currentFrame >= p.frameCount) {
+                p.currentFrame = 0;
+                // NB: a timer added by setFlags() has no function until one is set
+                if (p.fn)
+                    p.fn(i);
             }
-        }
+        });
     }
 
     void renderSystem()
     {
+        if (!Actor::enabled(Actor::Text | Actor::Trail))
+            return;
+
         // provide drawcontext
         // iterate - draw each
-        for (int i = 0; i < Setup::Actors; i++) {
-            if (_actors[i].flags != 0) {
-                if (_actors[i].flags & Actor::Text) {
-                    auto& pos = getPosition(i);
-                    auto& p = getText(i);
-
-                    for (int y = 0; y < Setup::ScreenHeight; y++) {
-                        if (p.line[y])
-                            drawContext.addText(pos.x, pos.y + y, p.line[y]);
-                    }
+        each<Position, Text>([this](EntityId, Position& pos, Text& t) {
+            const TextLine* l = &_textPool[t.first];
+            for (uint8_t y = 0; y < t.count; y++, l++) {
+                if (l->text) {
+                    _RW_PROFILE_COUNT(textsDrawn, 1);
+                    drawContext.addText(pos.x, pos.y + y, l->text, l->length);
                 }
             }
-        }
+        });
+
+        // trails are drawn over the texts, without an actor per segment
+        _forEachWithAny(Actor::Trail, [this](EntityId i) {
+            const auto& t = _components.trail[i];
+            const uint8_t first = t.firstAge(_components.position[i]);
+            int8_t x, y;
+            for (uint8_t age = first; age < first + t.length && t.at(age, x, y); age++) {
+                _RW_PROFILE_COUNT(textsDrawn, 1);
+                drawContext.addText(x, y, t.symbol);
+            }
+        });
     }
 
     // ----------------------------------------
 
-    void runLoop()
+    /// Sends the buffer changes since the last present to the peer functions, see runLoop(false)
+    /// NB: profiled as part of the last frame
+    void present()
+    {
+#if RW_SETUP_PROFILE
+        const auto t0 = profile.clock();
+        drawContext._end();
+        profile._addPresent(profile.clock() - t0, drawContext.peerCalls);
+        drawContext.peerCalls = 0;
+#else
+        drawContext._end();
+#endif
+    }
+
+    /// One simulation tick; 'presentFrame' = false leaves the buffer diff to a later present()
+    /// NB: skipped ticks are diffed against the last presented buffer, no changes are lost
+    void runLoop(bool presentFrame = true)
     {
-        inputSystem();
-        movementSystem();
-        collisionSystem();
-        lifetimeSystem();
-        timerSystem();
-        renderSystem();
+#if RW_SETUP_PROFILE
+        profile._beginFrame();
+#endif
+        _RW_PROFILE_SYSTEM(Present, drawContext._begin());
+
+#if RW_SETUP_COMMAND_BUFFER
+        _deferring = true;
+#endif
+        // NB: commands of each system are applied before the next one runs, so actors removed by a
+        // collision are not rendered and the buffer only holds the commands of one system pass
+        _RW_PROFILE_SYSTEM(Input, inputSystem(); _applyCommands());
+        _RW_PROFILE_SYSTEM(Movement, movementSystem(); _applyCommands());
+        _RW_PROFILE_SYSTEM(Collision, collisionSystem(); _applyCommands());
+        _RW_PROFILE_SYSTEM(Lifetime, lifetimeSystem(); _applyCommands());
+        _RW_PROFILE_SYSTEM(Timer, timerSystem(); _applyCommands());
+        _RW_PROFILE_SYSTEM(Render, renderSystem(); _applyCommands());
+#if RW_SETUP_COMMAND_BUFFER
+        _deferring = false;
+#endif
+
+        if (presentFrame)
+            _RW_PROFILE_SYSTEM(Present, drawContext._end());
+#if RW_SETUP_PROFILE
+        profile.frame.peerCalls = drawContext.peerCalls;
+        drawContext.peerCalls = 0;
+        profile._endFrame();
+#endif
     }
 
     // ----------------------------------------
 
-    static Engine& get()
+    static EngineT& get()
     {
-        static Engine ret {};
+        static EngineT ret {};
         return ret;
     }
 };
 
-Engine::DummyValues Engine::_dummyValues;
+template <typename Config>
+typename EngineT<Config>::DummyValues EngineT<Config>::_dummyValues;
+
+using Engine = EngineT<>;
 
 // static Engine &a16{Engine::get()};
 
@@ -1020,21 +3065,28 @@ Engine::DummyValues Engine::_dummyValues;
 
 #define COLLIDER_FN +[](const ::rwe::EntityId &receiver, const ::rwe::EntityId peer)
 
+// NB: the callback helpers are templated on the engine they reach through E::get(), the default one if omitted
+// e.g. .collider(1, HitPeer) or .collider(1, HitPeer<EngineT<SetupT<40, 25>>>)
+
 /// Helper function for the TEST_HIT macro
+template <typename E = Engine>
 static inline bool _TestHit(const EntityId &receiver, const EntityId peer)
 {
-    auto& pR = RWE.getPosition(receiver);
-    auto& pP = RWE.getPosition(peer);
+    auto& pR = E::get().getPosition(receiver);
+    auto& pP = E::get().getPosition(peer);
     return pR == pP;
 }
 
 #define TEST_HIT _TestHit(receiver, peer)
+/// TEST_HIT of the engine type E
+#define TEST_HIT_(E) _TestHit<E>(receiver, peer)
 
+template <typename E = Engine>
 static inline void HitReceiver(const EntityId& receiver, const EntityId peer)
 {
-    if (TEST_HIT) {
-        auto peerHitValue = RWE.getCollider(peer).value;
-        auto& receiverHp = RWE.getHitpoints(receiver);
+    if (_TestHit<E>(receiver, peer)) {
+        auto peerHitValue = E::get().getCollider(peer).value;
+        auto& receiverHp = E::get().getHitpoints(receiver);
         if (receiverHp.hp > peerHitValue)
             receiverHp.hp -= peerHitValue;
         else
@@ -1042,11 +3094,12 @@ static inline void HitReceiver(const EntityId& receiver, const EntityId peer)
     }
 }
 
+template <typename E = Engine>
 static inline void HitPeer(const EntityId& receiver, const EntityId peer)
 {
-    if (TEST_HIT) {
-        auto hitValue = RWE.getCollider(receiver).value;
-        auto& peerHp = RWE.getHitpoints(peer);
+    if (_TestHit<E>(receiver, peer)) {
+        auto hitValue = E::get().getCollider(receiver).value;
+        auto& peerHp = E::get().getHitpoints(peer);
         if (peerHp.hp > hitValue)
             peerHp.hp -= hitValue;
         else
@@ -1055,16 +3108,17 @@ static inline void HitPeer(const EntityId& receiver, const EntityId peer)
 }
 
 /// macros only for the uniform syntax
-#define COLLIDER_HIT_RECEIVER HitReceiver
-#define COLLIDER_HIT_PEER HitPeer
+#define COLLIDER_HIT_RECEIVER HitReceiver<>
+#define COLLIDER_HIT_PEER HitPeer<>
 
 // --------------------------------------------------------------------------------
 // Input handler functions
 
 /// Disallow speed inversion in any axis
+template <typename E = Engine>
 static inline void NonInvertingControl(const EntityId &receiver, const RawControlState &input)
 {
-    auto& engine = Engine::get();
+    auto& engine = E::get();
     auto& speed = engine.getSpeed(receiver);
 
     // Change direction on input, but prevent reverse direction
@@ -1161,42 +3215,49 @@ void TimerOnceAndRemoveThis()
 }
 
 /// remove the receiver after timer's interval
-void TimerRemoveThis(const ::rwe::EntityId &receiver)
+template <typename E = Engine>
+static inline void TimerRemoveThis(const ::rwe::EntityId &receiver)
 {
-    RWE.remove(receiver);
+    E::get().remove(receiver);
 }
 
 #define TIMER_ONCE_(x) ::rwe::TimerOnce<x>()
 #define TIMER_ONCE_AND_REMOVE_THIS_(x) ::rwe::TimerOnceAndRemoveThis<x>()
-#define TIMER_REMOVE_THIS ::rwe::TimerRemoveThis
+#define TIMER_REMOVE_THIS ::rwe::TimerRemoveThis<>
 
 // --------------------------------------------------------------------------------
 // Pre-made actors
 
 namespace A {
 
-/// clear background ScreenWidth x ScreenHeight
-static inline Engine::ActorBuilder Background(Engine &ctx = RWE, const char symbol = ' ')
+/// clear background ScreenWidth x ScreenHeight of the engine 'ctx'
+/// NB: templates on the engine type, they also compile with features disabled until used
+template <typename E = Engine>
+static inline typename E::ActorBuilder Background(E &ctx = E::get(), const char symbol = ' ')
 {
-    static char textLine[Setup::ScreenWidth];
-    for (int i = 0; i < Setup::ScreenWidth; i++)
+    using Config = typename E::ConfigType;
+    static char textLine[Config::ScreenWidth + 1];
+    for (int i = 0; i < Config::ScreenWidth; i++)
         textLine[i] = symbol;
+    textLine[Config::ScreenWidth] = 0;
 
     auto r = ctx //
                  .make();
 
-    for (int i = 0; i < Setup::ScreenHeight; i++)
+    for (int i = 0; i < Config::ScreenHeight; i++)
         r.textLine(i, textLine);
 
     return r;
 }
-static inline Engine::ActorBuilder Background(const char symbol)
+template <typename E = Engine>
+static inline typename E::ActorBuilder Background(const char symbol)
 {
-    return Background(RWE, symbol);
+    return Background<E>(E::get(), symbol);
 }
 
 /// Movable player character
-static inline Engine::ActorBuilder PlayerChar(Engine &ctx = RWE, const char *c = "#")
+template <typename E = Engine>
+static inline typename E::ActorBuilder PlayerChar(E &ctx = E::get(), const char *c = "#")
 {
     return ctx //
         .make(Actor::Move | Actor::Control)
@@ -1204,9 +3265,10 @@ static inline Engine::ActorBuilder PlayerChar(Engine &ctx = RWE, const char *c =
 }
 
 // alias
-static inline Engine::ActorBuilder PlayerChar(const char *c)
+template <typename E = Engine>
+static inline typename E::ActorBuilder PlayerChar(const char *c)
 {
-    return PlayerChar(RWE, c);
+    return PlayerChar<E>(E::get(), c);
 }
 
 } // namespace A
@@ -1218,21 +3280,27 @@ typedef void (*PageFn)(Engine &);
 
 #define PAGE_FN +[](Engine & page)
 
-class PageManager
+/// Pages of the engine type E, switched on its E::get() singleton
+template <typename E = Engine>
+class PageManagerT
 {
-    PageFn _pages[Setup::PageCount];
+public:
+    typedef void (*PageFn)(E &);
+
+private:
+    PageFn _pages[E::ConfigType::PageCount];
 
-    PageManager()
+    PageManagerT()
     {
-        for (auto i = 0; i < Setup::PageCount; i++) {
-            _pages[i] = PAGE_FN{};
+        for (auto i = 0; i < E::ConfigType::PageCount; i++) {
+            _pages[i] = +[](E &) {};
         }
     }
 
 public:
     void setPage(uint8_t idx, PageFn fn)
     {
-        if (idx >= Setup::PageCount)
+        if (idx >= E::ConfigType::PageCount)
             return;
 
         _pages[idx] = fn;
@@ -1240,25 +3308,147 @@ public:
 
     void switchPage(uint8_t idx)
     {
-        if (idx >= Setup::PageCount)
+        if (idx >= E::ConfigType::PageCount)
             return;
 
-        // auto ctx = RWE.drawContext;
-        RWE.reset();
-        // RWE.drawContext = ctx;
-        _pages[idx](RWE);
+        auto& engine = E::get();
+        engine.reset();
+        _pages[idx](engine);
     }
 
-    static PageManager &get()
+    static PageManagerT &get()
     {
-        static PageManager obj;
+        static PageManagerT obj;
         return obj;
     }
 };
 
+using PageManager = PageManagerT<>;
+
 #define SET_PAGE_(idx, ...) PageManager::get().setPage(idx, +[](Engine & page) __VA_ARGS__)
 #define SWITCH_PAGE(x) PageManager::get().switchPage(x)
 
+// --------
+// Fixed timestep
+
+/// Decides when to run Engine::runLoop() and when to present, for loops with a microsecond clock
+/// NB: times are wrapping uint32_t microseconds, i.e. micros() on Arduino
+struct Scheduler
+{
+    struct Stats {
+        uint32_t ticks {};
+        uint32_t presents {};
+        /// ticks dropped after maxFrameSkip catch-up ticks
+        uint32_t skippedTicks {};
+
+        /// lateness of ticks / presents against their schedule
+        uint32_t maxTickJitter {};
+        uint32_t maxPresentJitter {};
+        uint32_t totalTickJitter {};
+        uint32_t totalPresentJitter {};
+
+        uint32_t averageTickJitter() const { return ticks ? totalTickJitter / ticks : 0; }
+        uint32_t averagePresentJitter() const
+        {
+            return presents ? totalPresentJitter / presents : 0;
+        }
+    };
+
+    uint32_t tickMicros { 100000 };
+    /// 0: present after each frame with ticks
+    uint32_t presentMicros { 0 };
+    /// catch-up ticks per frame after the first one
+    uint8_t maxFrameSkip { 4 };
+
+    Stats stats {};
+
+    Scheduler() = default;
+    Scheduler(uint32_t tick, uint32_t present = 0, uint8_t frameSkip = 4)
+        : tickMicros(tick)
+        , presentMicros(present)
+        , maxFrameSkip(frameSkip)
+    {
+    }
+
+    void start(uint32_t now)
+    {
+        _nextTick = now;
+        _nextPresent = now;
+        stats = Stats();
+    }
+
+    /// Number of Engine::runLoop() calls due at 'now'
+    uint8_t ticksDue(uint32_t now)
+    {
+        uint8_t count = 0;
+        while (_reached(now, _nextTick)) {
+            if (count > maxFrameSkip) {
+                // too far behind: drop the rest and restart the schedule
+                while (_reached(now, _nextTick)) {
+                    _nextTick += tickMicros;
+                    stats.skippedTicks++;
+                }
+                break;
+            }
+
+            _addJitter(now - _nextTick, stats.maxTickJitter, stats.totalTickJitter);
+            stats.ticks++;
+            _nextTick += tickMicros;
+            count++;
+        }
+        _ticked = _ticked || count;
+        return count;
+    }
+
+    /// true if the frame should be presented at 'now'
+    bool presentDue(uint32_t now)
+    {
+        if (!presentMicros) {
+            if (!_ticked)
+                return false;
+            _ticked = false;
+            stats.presents++;
+            return true;
+        }
+
+        if (!_reached(now, _nextPresent))
+            return false;
+
+        _addJitter(now - _nextPresent, stats.maxPresentJitter, stats.totalPresentJitter);
+        stats.presents++;
+        _nextPresent += presentMicros;
+        if (_reached(now, _nextPresent))
+            _nextPresent = now + presentMicros;
+        return true;
+    }
+
+    /// Microseconds until the next tick or present
+    uint32_t timeToNext(uint32_t now) const
+    {
+        uint32_t ret = _reached(now, _nextTick) ? 0 : _nextTick - now;
+        if (presentMicros) {
+            const uint32_t p = _reached(now, _nextPresent) ? 0 : _nextPresent - now;
+            if (p < ret)
+                ret = p;
+        }
+        return ret;
+    }
+
+protected:
+    uint32_t _nextTick {};
+    uint32_t _nextPresent {};
+    bool _ticked { false };
+
+    static bool _reached(uint32_t now, uint32_t t) { return int32_t(now - t) >= 0; }
+
+    static void _addJitter(uint32_t j, uint32_t &maxValue, uint32_t &total)
+    {
+        if (j > maxValue)
+            maxValue = j;
+        total += j;
+    }
+};
+
 //
 
 /// Wrapper for 'if let value = Optional<T>' syntax: IF_LET(optional, { value = 0; })
@@ -0,0 +1,90 @@
+// Built with only some features, e.g. RW_SETUP_FEATURES=(Actor::Text | Actor::Input), see CMakeLists.txt
+#include "rowguelike.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace rwe ;
+
+#define TEST_ASSERT(expr) \
+    do { \
+        if (!(expr)) { \
+            std::cerr << "Test failed: " << #expr << "\n" \
+                      << "  File: " << __FILE__ << "\n" \
+                      << "  Line: " << __LINE__ << "\n"; \
+            std::exit(EXIT_FAILURE); \
+        } else \
+            std::cout << "[ OK ] Line: " << __LINE__ << " Code: '" << #expr << "'\n"; \
+    } while (0)
+
+// -----
+
+static int selectCalls { 0 };
+
+static void menuInput(const EntityId &, const RawControlState &rawInput)
+{
+    if (rawInput.select)
+        selectCalls++;
+}
+
+constexpr SceneActor menuScene[] RW_PROGMEM = {
+    SceneActor().text("menu").input(menuInput),
+    SceneActor().position(0, 1).text("item"),
+};
+
+// -----
+
+int main()
+{
+    puts("tests started");
+
+    printf("Features: 0x%x\n", unsigned(Actor::Features));
+    std::cout << "sizeof(Engine) " << sizeof(Engine) << ", sizeof(Engine::ActorBuilder) " << sizeof(Engine::ActorBuilder)
+              << ", sizeof(Components) " << sizeof(Components) << "\n";
+
+    puts("");
+
+    // Disabled storages and builder values are empty
+    TEST_ASSERT(Actor::Features == (Actor::Text | Actor::Input));
+    TEST_ASSERT(sizeof(Components::speed) == 1 && sizeof(Components::hitpoints) == 1);
+    TEST_ASSERT(sizeof(Components::collider) == 1 && sizeof(Components::timer) == 1);
+    TEST_ASSERT(sizeof(Components::parent) == 1 && sizeof(Components::trail) == 1);
+    TEST_ASSERT(sizeof(_BuilderValue<Engine::Speed, false>) == 1 && sizeof(_BuilderValue<Engine::Timer, false>) == 1);
+
+    // Spawn, input and render
+    RWE.reset();
+    TEST_ASSERT(RWE.make().text("hi").input(menuInput).spawn().value() == 0);
+    TEST_ASSERT(RWE.getActor(0).flags == (Actor::Text | Actor::Input));
+    RWE.rawInput.select = true;
+    RWE.runLoop();
+    RWE.rawInput.select = false;
+    TEST_ASSERT(selectCalls == 1 && strncmp(RWE.drawContext.buffer[0], "hi", 2) == 0);
+
+    // disabled flags are dropped, their getters return the dummy
+    TEST_ASSERT(RWE.setFlags(0, Actor::Move | Actor::Text));
+    TEST_ASSERT(RWE.getActor(0).flags == Actor::Text);
+    RWE.getSpeed(0).vx = 1;
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(0).x == 0 && selectCalls == 1);
+
+    // Text pool
+    TEST_ASSERT(RWE.setTextLine(0, 1, "there") && RWE.textLinesUsed() == 2);
+    RWE.runLoop();
+    TEST_ASSERT(strncmp(RWE.drawContext.buffer[1], "there", 5) == 0);
+
+    // Scene tables, remove and compact
+    TEST_ASSERT(RWE.loadScene(menuScene) == 2);
+    TEST_ASSERT(strcmp(RWE.getTextLine(1, 0), "menu") == 0 && RWE.getInput(1).inputFn == menuInput);
+    RWE.remove(0);
+    TEST_ASSERT(RWE.textLinesUsed() == 2);
+    RWE.compact();
+    TEST_ASSERT(strcmp(RWE.getTextLine(0, 0), "menu") == 0 && RWE.getPosition(1).y == 1);
+    RWE.rawInput.select = true;
+    RWE.runLoop();
+    TEST_ASSERT(selectCalls == 2);
+
+    puts("");
+    puts("tests completed");
+}
@@ -19,14 +19,61 @@ using namespace rwe ;
 
 // -----
 
+int colliderCalls { 0 };
+
+static int remapCalls { 0 };
+
+static int removedPeerCalls { 0 };
+static int thirdCalls { 0 };
+static int wrongReceiverCalls { 0 };
+
+static int updatedRuns { 0 };
+static int updatedCells { 0 };
+
+static void sceneTimer(const EntityId &) {}
+
+using SharedScore = SharedKey<uint16_t>;
+using SharedFlag = SharedKey<bool, SharedScore::End>;
+using SharedPtr = SharedKey<void *, SharedFlag::End>;
+static_assert(SharedKeysApart<SharedScore, SharedFlag, SharedPtr>::value, "shared keys overlap");
+static_assert(!SharedKeysApart<SharedScore, SharedKey<uint8_t, 1>>::value, "overlapping keys not detected");
+
+// Setup with a text pool of two lines
+struct TwoLines : Setup {
+    static constexpr uint16_t TextLines { 2 };
+};
+
+struct FourLines : Setup {
+    static constexpr uint16_t TextLines { 4 };
+};
+
+constexpr SceneActor testScene[] RW_PROGMEM = {
+    SceneActor(Actor::Move).position(1, 0).speed(1, 0).text("a"),
+    SceneActor(),
+    SceneActor().position(2, 1).text("b", "c").hitpoints(3).withTag(2),
+    SceneActor().timer(4, sceneTimer),
+};
+
+constexpr SceneActor groupScene[] RW_PROGMEM = {
+    SceneActor(Actor::Move).group(2),
+};
+
+// each setter replaces one part and keeps the others
+static_assert(testScene[2].x == 2 && testScene[2].hp == 3 && testScene[2].tag == 2 && testScene[2].mask == 0xFF, "scene setters");
+static_assert(SceneActor().collider(1, nullptr, 9).control().group(1).layer == 1, "scene collider layer");
+static_assert(testScene[0].flags == (Actor::Move | Actor::Text) && groupScene[0].groups == 4, "scene flags");
+
+// -----
+
 int main()
 {
     puts("tests started");
 
     //
-    printf("Actors count: %hhu\n", Setup::Actors);
+    printf("Actors count: %u\n", unsigned(Setup::Actors));
     printf("Components size: %lu\n", sizeof(Components));
     printf("Engine size: %lu\n", sizeof(RWE));
+    printf("Features: 0x%x\n", unsigned(Actor::Features));
 
     puts("");
 
@@ -40,7 +87,7 @@ int main()
     // TEST_ASSERT(b.entity == 0);
     TEST_ASSERT(RWE.getPosition(0).x == 3);
     TEST_ASSERT(RWE.getPosition(0).y == 1);
-    TEST_ASSERT(strncmp(RWE.getText(0).line[0], "*", 1) == 0);
+    TEST_ASSERT(strncmp(RWE.getTextLine(0, 0), "*", 1) == 0);
 
     auto b1 = RWE.make(Actor::Input);
     b1.input(+[](const EntityId &, const RawControlState &) {});
@@ -48,6 +95,546 @@ int main()
 
     RWE.runLoop();
 
+    // Free slots
+    RWE.reset();
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 0);
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 1);
+    RWE.remove(0);
+    RWE.remove(0);
+    TEST_ASSERT(RWE.getFreeEntityId().value() == 0);
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 0);
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 2);
+
+    for (int i = 3; i < Setup::Actors; i++)
+        RWE.make(Actor::Move).spawn();
+    TEST_ASSERT(!RWE.canSpawn());
+    TEST_ASSERT(!RWE.make(Actor::Move).spawn().has_value());
+
+    RWE.remove(Setup::Actors - 1);
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == Setup::Actors - 1);
+
+    RWE.reset();
+    TEST_ASSERT(RWE.make(Actor::Health).hitpoints(0).spawn().value() == 0);
+    RWE.lifetimeSystem();
+    TEST_ASSERT(!RWE.isActiveActor(0));
+    TEST_ASSERT(RWE.getFreeEntityId().value() == 0);
+
+    // Handles
+    RWE.reset();
+    const auto handle = RWE.handle(RWE.make(Actor::Move).spawn().value());
+    TEST_ASSERT(RWE.isValid(handle));
+    RWE.remove(handle.id);
+    TEST_ASSERT(!RWE.isValid(handle));
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == handle.id);
+#if RW_SETUP_HANDLES
+    TEST_ASSERT(!RWE.isValid(handle));
+    TEST_ASSERT(RWE.isValid(RWE.handle(handle.id)));
+#endif
+
+    // Per-flag sets
+    RWE.reset();
+    RWE.make(Actor::Move).position(0, 0).speed(1, 0).spawn();
+    RWE.make().position(0, 0).speed(1, 0, true).text("x").spawn();
+    RWE.make(Actor::Move).position(0, 0).speed(1, 0).spawn();
+    RWE.remove(2);
+    RWE.movementSystem();
+    TEST_ASSERT(RWE.getPosition(0).x == 1);
+    TEST_ASSERT(RWE.getPosition(1).x == 0);
+    TEST_ASSERT(RWE.getPosition(2).x == 0);
+
+    RWE.setFlags(1, Actor::Text | Actor::Move);
+    RWE.movementSystem();
+    TEST_ASSERT(RWE.getPosition(0).x == 2);
+    TEST_ASSERT(RWE.getPosition(1).x == 1);
+
+    // Active end and compaction
+    RWE.reset();
+    TEST_ASSERT(RWE.activeEnd() == 0);
+    for (int i = 0; i < 5; i++)
+        RWE.make(Actor::Move).position(i, 0).spawn();
+    RWE.setTag(4, 1);
+    RWE.remove(1);
+    RWE.remove(3);
+    TEST_ASSERT(RWE.activeEnd() == 5);
+    remapCalls = 0;
+    RWE.compact(+[](EntityId from, EntityId to) { remapCalls += from - to; });
+    TEST_ASSERT(remapCalls == 3);
+    TEST_ASSERT(RWE.activeEnd() == 3);
+    TEST_ASSERT(RWE.getPosition(1).x == 2 && RWE.getPosition(2).x == 4);
+    TEST_ASSERT(RWE.getIdByTag(1).value() == 2);
+    RWE.movementSystem();
+    TEST_ASSERT(RWE.getFreeEntityId().value() == 3);
+    RWE.remove(2);
+    TEST_ASSERT(RWE.activeEnd() == 2);
+    RWE.remove(0);
+    RWE.remove(1);
+    TEST_ASSERT(RWE.activeEnd() == 0);
+
+    // Component queries
+    RWE.reset();
+    RWE.make(Actor::Move).position(1, 0).speed(2, 0).spawn();
+    RWE.make(Actor::Move | Actor::Health).position(2, 0).speed(3, 0).hitpoints(4).spawn();
+    RWE.make(Actor::Health).position(3, 0).hitpoints(5).spawn();
+    static int queried;
+    queried = 0;
+    RWE.each<Components::Position>([](EntityId, Components::Position &p) { queried += p.x; });
+    TEST_ASSERT(queried == 6);
+    queried = 0;
+    RWE.each<Components::Speed, Components::Hitpoints>(
+        [](EntityId id, Components::Speed &s, Components::Hitpoints &h) { queried += id * 100 + s.vx * h.hp; });
+    TEST_ASSERT(queried == 112);
+    queried = 0;
+    RWE.each<Actor::Health>([](EntityId id) { queried += id; });
+    TEST_ASSERT(queried == 3);
+
+    // Builder writes
+    // NB: a flag added later must not revive the timer of the slot's previous actor
+    RWE.reset();
+    static int staleTimerCalls;
+    staleTimerCalls = 0;
+    RWE.make(Actor::Text).text("old").timer(1, TIMER_FN { staleTimerCalls++; }).spawn();
+    RWE.remove(0);
+    RWE.make().text("new").spawn();
+    TEST_ASSERT(RWE.setFlags(0, Actor::Text | Actor::Timer));
+    RWE.runLoop();
+    TEST_ASSERT(staleTimerCalls == 0 && RWE.getTimer(0).fn == nullptr);
+
+    RWE.reset();
+    RWE.make(Actor::Move).speed(2, 1).text("s").hitpoints(7).spawn();
+    RWE.remove(0);
+    RWE.make(Actor::Text).position(1, 1).text("t").spawn();
+    TEST_ASSERT(RWE.getSpeed(0).vx == 0 && RWE.getHitpoints(0).hp == 0);
+    TEST_ASSERT(RWE.getPosition(0).x == 1 && strcmp(RWE.getTextLine(0, 0), "t") == 0);
+    RWE.remove(0);
+    RWE.make(Actor::Move).spawn();
+    TEST_ASSERT(RWE.getSpeed(0).vx == 0 && RWE.getPosition(0).x == 0);
+    RWE.make(Actor::Move).speed(-1, 0, true).spawn();
+    TEST_ASSERT(RWE.getSpeed(1).vx == -1 && RWE.getActor(1).flags == Actor::Move);
+    RWE.getSpeed(0).vx = 3;
+    TEST_ASSERT(RWE.clone(0).spawn().value() == 2);
+    TEST_ASSERT(RWE.getSpeed(2).vx == 3);
+
+    // Text pool
+    RWE.reset();
+    RWE.make(Actor::Text).position(0, 0).text("ab").spawn();
+    RWE.make(Actor::Text).position(0, 1).text("cd").spawn();
+    TEST_ASSERT(RWE.textLinesUsed() == 2);
+    TEST_ASSERT(RWE.setTextLine(0, 1, "ef"));
+    TEST_ASSERT(RWE.getText(0).count == 2 && strcmp(RWE.getTextLine(0, 0), "ab") == 0);
+    TEST_ASSERT(RWE.textLinesUsed() == 3);
+    TEST_ASSERT(!RWE.setTextLine(0, Setup::ScreenHeight, "x"));
+    TEST_ASSERT(!RWE.setTextLine(2, 0, "x"));
+    TEST_ASSERT(RWE.setTextLine(1, 0, "xyz"));
+    RWE.runLoop();
+    TEST_ASSERT(strncmp(RWE.drawContext.buffer[0], "ab", 2) == 0 && strncmp(RWE.drawContext.buffer[1], "xyz", 3) == 0);
+    RWE.remove(0);
+    TEST_ASSERT(RWE.textLinesUsed() == 1);
+    RWE.compact();
+    TEST_ASSERT(strcmp(RWE.getTextLine(0, 0), "xyz") == 0 && RWE.textLinesUsed() == 1);
+    static EngineT<TwoLines> small;
+    TEST_ASSERT(small.make().text("a", "b").spawn().has_value());
+    TEST_ASSERT(!small.make().text("c").spawn().has_value());
+    TEST_ASSERT(small.make(Actor::Move).spawn().has_value());
+    // runs are consecutive lines: free lines split by other runs are packed when no run fits
+    static EngineT<FourLines> split;
+    static const char* const letters[] = { "a", "b", "c", "d" };
+    for (int i = 0; i < 4; i++)
+        split.make().text(letters[i]).spawn();
+    split.remove(0);
+    split.remove(2);
+    TEST_ASSERT(split.textLinesUsed() == 2 && split.setTextLine(3, 1, "e"));
+    TEST_ASSERT(strcmp(split.getTextLine(3, 0), "d") == 0 && strcmp(split.getTextLine(3, 1), "e") == 0);
+    TEST_ASSERT(strcmp(split.getTextLine(1, 0), "b") == 0 && split.textLinesUsed() == 3);
+    TEST_ASSERT(!split.make().text("f", "g").spawn().has_value() && split.make().text("h").spawn().has_value());
+    // dropping Text returns the lines, the actor stays
+    split.reset();
+    split.make(Actor::Move).text("a", "b").spawn();
+    TEST_ASSERT(split.textLinesUsed() == 2 && split.setFlags(0, Actor::Move));
+    TEST_ASSERT(split.textLinesUsed() == 0 && split.isActiveActor(0) && !split.getTextLine(0, 0));
+    TEST_ASSERT(Setup::TextLines >= Setup::Actors && Setup::TextLines <= Setup::Actors + Setup::ScreenHeight);
+
+    // Parents
+    RWE.reset();
+    RWE.make(Actor::Text).text("x").spawn();
+    RWE.make(Actor::Text).parent(3, 0, 1).text("c").spawn();
+    RWE.make(Actor::Text).parent(1, 2, 0).text("g").spawn();
+    RWE.make(Actor::Move).position(4, 0).speed(1, 0).spawn();
+    RWE.remove(0);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(1).x == 5 && RWE.getPosition(1).y == 1);
+    TEST_ASSERT(RWE.getPosition(2).x == 7 && RWE.getPosition(2).y == 1);
+    RWE.compact();
+    TEST_ASSERT(RWE.getParent(0).id == 2 && RWE.getParent(1).id == 0);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(1).x == 8 && RWE.getPosition(1).y == 1);
+    RWE.getParent(0).id = 1;
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(1).x == 8);
+    RWE.getParent(0).id = 2;
+    RWE.remove(2);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(0).x == 6 && RWE.getPosition(1).x == 8);
+    // the removed parent's slot is reused: its children are not adopted
+    TEST_ASSERT(RWE.getParent(0).id == Setup::Actors);
+    TEST_ASSERT(RWE.make(Actor::Move).position(0, 0).speed(1, 0).spawn().value() == 2);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(0).x == 6 && RWE.getPosition(0).y == 1 && RWE.getPosition(1).x == 8);
+    TEST_ASSERT(RWE.make(Actor::Text).parent(2, -5, 0).text("l").spawn().value() == 3);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(3).x == 0 && RWE.getPosition(3).y == 0);
+
+    // Tag groups
+    RWE.reset();
+    RWE.make(Actor::Move).speed(1, 0).group(0).spawn();
+    RWE.make(Actor::Move).speed(1, 0).group(0).group(1).spawn();
+    RWE.make(Actor::Move).speed(1, 0).spawn();
+    RWE.joinGroup(2, 1);
+    RWE.joinGroup(3, 1);
+    TEST_ASSERT(RWE.groupCount(0) == 2 && RWE.groupCount(1) == 2);
+    TEST_ASSERT(RWE.inGroup(1, 0) && !RWE.inGroup(2, 0) && !RWE.inGroup(3, 1));
+    static int grouped;
+    grouped = 0;
+    RWE.eachInGroup(1, [](EntityId id) { grouped += id; });
+    TEST_ASSERT(grouped == 3);
+    RWE.pauseGroup(0);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(0).x == 0 && RWE.getPosition(1).x == 0 && RWE.getPosition(2).x == 1);
+    RWE.pauseGroup(0, false);
+    RWE.remove(0);
+    RWE.leaveGroup(1, 0);
+    TEST_ASSERT(!RWE.groupAny(0) && RWE.groupAny(1));
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 0 && !RWE.inGroup(0, 0));
+    RWE.remove(0);
+    RWE.compact();
+    TEST_ASSERT(RWE.inGroup(0, 1) && RWE.inGroup(1, 1) && RWE.groupCount(1) == 2);
+    RWE.setPrefab(2, &groupScene[0]);
+    TEST_ASSERT(RWE.spawnMany(2, 3) == 3 && RWE.groupCount(2) == 3);
+
+    // Scene tables
+    RWE.reset();
+    RWE.make(Actor::Text).text("x").spawn();
+    TEST_ASSERT(RWE.loadScene(testScene) == 4);
+    TEST_ASSERT(RWE.activeEnd() == 5);
+    TEST_ASSERT(RWE.getPosition(1).x == 1 && RWE.getSpeed(1).vx == 1);
+    TEST_ASSERT(RWE.getActor(1).flags == ((Actor::Move | Actor::Text) & Actor::Features));
+    TEST_ASSERT(!RWE.isActiveActor(2));
+    TEST_ASSERT(RWE.getIdByTag(2).value() == 3);
+    TEST_ASSERT(RWE.getHitpoints(3).hp == 3 && strcmp(RWE.getTextLine(3, 1), "c") == 0);
+    TEST_ASSERT(RWE.getTimer(4).frameCount == 4 && RWE.getTimer(4).fn == sceneTimer);
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == 2);
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(1).x == 2);
+
+    // scene loaded with the last slot in use: entries go to the slots freed below it
+    RWE.reset();
+    for (int i = 0; i < Setup::Actors; i++)
+        RWE.make(Actor::Move).spawn();
+    for (int i = 0; i < 3; i++)
+        RWE.remove(i);
+    TEST_ASSERT(RWE.loadScene(testScene) == 4);
+    TEST_ASSERT(RWE.getPosition(0).x == 1 && RWE.getHitpoints(1).hp == 3 && RWE.getTimer(2).frameCount == 4);
+    TEST_ASSERT(!RWE.canSpawn());
+
+    // Prefabs
+    RWE.reset();
+    RWE.setPrefab(1, &testScene[0]);
+    TEST_ASSERT(RWE.spawnMany(0, 3) == 0);
+    int8_t step = 2;
+    TEST_ASSERT(RWE.spawnMany(1, 3, [step](uint16_t i, Components::Position &p) { p.x = int8_t(i * step); }) == 3);
+    RWE.remove(1);
+    TEST_ASSERT(RWE.spawnMany(1, Setup::Actors) == Setup::Actors - 2);
+    TEST_ASSERT(!RWE.canSpawn());
+    TEST_ASSERT(RWE.getPosition(1).x == 1 && RWE.getPosition(2).x == 4);
+    TEST_ASSERT(RWE.getSpeed(Setup::Actors - 1).vx == 1);
+    TEST_ASSERT(RWE.activeEnd() == Setup::Actors);
+
+#if RW_SETUP_MAX_TIMER
+    // Sparse storage
+    RWE.reset();
+    for (int i = 0; i < Setup::MaxTimer; i++)
+        TEST_ASSERT(RWE.make().timer(i + 1, TIMER_FN {}).spawn().has_value());
+    TEST_ASSERT(!RWE.make().timer(1, TIMER_FN {}).spawn().has_value());
+    TEST_ASSERT(RWE.make(Actor::Move).spawn().value() == Setup::MaxTimer);
+    TEST_ASSERT(!RWE.setFlags(Setup::MaxTimer, Actor::Timer));
+    RWE.remove(0);
+    TEST_ASSERT(RWE.getTimer(Setup::MaxTimer - 1).frameCount == Setup::MaxTimer);
+    TEST_ASSERT(RWE.setFlags(Setup::MaxTimer, Actor::Move | Actor::Timer));
+    TEST_ASSERT(RWE.getTimer(Setup::MaxTimer).fn == nullptr);
+    RWE.getTimer(Setup::MaxTimer).frameCount = 9;
+    RWE.getTimer(Setup::MaxTimer).fn = TIMER_FN {};
+    RWE.timerSystem();
+    TEST_ASSERT(RWE.getTimer(1).currentFrame == 1);
+    TEST_ASSERT(RWE.getTimer(Setup::MaxTimer).currentFrame == 1);
+#endif
+
+#if RW_SETUP_MAX_TRAIL
+    // Trails
+    RWE.reset();
+    RWE.make(Actor::Move).position(0, 0).speed(1, 0).text("@").trail(3, "o").spawn();
+    for (int i = 0; i < 6; i++)
+        RWE.runLoop();
+    TEST_ASSERT(RWE.getTrail(0).count == Setup::TrailLength);
+    int8_t tx, ty;
+    TEST_ASSERT(RWE.getTrail(0).at(0, tx, ty) && tx == 6);
+    TEST_ASSERT(RWE.getTrail(0).at(3, tx, ty) && tx == 3);
+    TEST_ASSERT(!RWE.getTrail(0).at(Setup::TrailLength, tx, ty));
+    TEST_ASSERT(strncmp(&RWE.drawContext.buffer[0][3], "ooo@", 4) == 0);
+    RWE.setFlags(0, Actor::Text | Actor::Trail);
+    RWE.runLoop();
+    TEST_ASSERT(strncmp(&RWE.drawContext.buffer[0][3], "ooo@", 4) == 0);
+    TEST_ASSERT(RWE.make().trail(1, "-").spawn().has_value());
+    TEST_ASSERT(!RWE.make().trail(1, "-").spawn().has_value());
+#endif
+
+#if RW_SETUP_COMMAND_BUFFER
+    // Deferred commands
+    RWE.reset();
+    colliderCalls = 0;
+    for (int i = 0; i < 3; i++)
+        RWE.make().position(1, 0).collider(1, COLLIDER_FN {
+            colliderCalls++;
+            RWE.remove(peer);
+        }).spawn();
+    RWE.runLoop();
+    TEST_ASSERT(colliderCalls == 6);
+    TEST_ASSERT(RWE.activeEnd() == 0);
+
+    // NB: spawns past the buffer size fail, the buffer is not applied mid-pass
+    RWE.make().eachFrame(TIMER_FN {
+        RWE.reset();
+        for (int i = 0; i < Setup::CommandBuffer + 2; i++) {
+            const auto id = RWE.make(Actor::Move).position(i, 0).spawn();
+            TEST_ASSERT(id.has_value() == (i < Setup::CommandBuffer));
+            TEST_ASSERT(!id.has_value() || !RWE.isActiveActor(id.value()));
+        }
+    }).spawn();
+    RWE.runLoop();
+    static int moving;
+    moving = 0;
+    RWE.each<Actor::Move>([](EntityId) { moving++; });
+    TEST_ASSERT(moving == Setup::CommandBuffer);
+    RWE.each<Actor::Timer>([](EntityId) { moving = 0; });
+    TEST_ASSERT(moving == Setup::CommandBuffer);
+
+    // a pending reset ends the system pass: the second game over timer does not run
+    RWE.reset();
+    static int gameOvers;
+    gameOvers = 0;
+    for (int i = 0; i < 2; i++)
+        RWE.make().eachFrame(TIMER_FN {
+            gameOvers++;
+            RWE.reset();
+            RWE.make(Actor::Text).text("Game Over").spawn();
+        }).spawn();
+    RWE.runLoop();
+    moving = 0;
+    RWE.each<Actor::Text>([](EntityId) { moving++; });
+    RWE.each<Actor::Timer>([](EntityId) { moving = 0; });
+    TEST_ASSERT(moving == 1 && gameOvers == 1);
+
+    // scene loaded by a system after a reset: spawned at the sync point, not into the slots still in use
+    // NB: the timers fill RW_SETUP_MAX_TIMER, the reset releases them for the scene's timer
+    RWE.reset();
+    for (int i = 0; i < 3; i++)
+        RWE.make(Actor::Move).timer(100, TIMER_FN {}).spawn();
+    static EntityId sceneFirst;
+    sceneFirst = Setup::Actors;
+    RWE.make().eachFrame(TIMER_FN {
+        RWE.reset();
+        RWE.make(Actor::Text).text("bg").spawn();
+        TEST_ASSERT(RWE.loadScene(testScene, &sceneFirst) == 4);
+        TEST_ASSERT(!RWE.isActiveActor(sceneFirst) && RWE.isActiveActor(0));
+    }).spawn();
+    RWE.runLoop();
+    TEST_ASSERT(!RWE.isActiveActor(0) && RWE.isActiveActor(sceneFirst));
+    TEST_ASSERT(RWE.getPosition(sceneFirst).x == 1 && RWE.getSpeed(sceneFirst).vx == 1);
+    TEST_ASSERT(RWE.getHitpoints(RWE.getIdByTag(2).value()).hp == 3);
+    TEST_ASSERT(RWE.getTimer(RWE.getIdByTag(2).value() + 1).frameCount == 4);
+
+    // a deferred reset clears like reset(): the paused group runs again
+    RWE.reset();
+    RWE.pauseGroup(0);
+    RWE.make().eachFrame(TIMER_FN { RWE.reset(); }).spawn();
+    RWE.runLoop();
+    RWE.make(Actor::Move).speed(1, 0).group(0).spawn();
+    RWE.runLoop();
+    TEST_ASSERT(RWE.getPosition(0).x == 1 && RWE.activeEnd() == 1);
+
+    // removes past the buffer size fail, those actors stay
+    RWE.reset();
+    static int removed;
+    removed = 0;
+    for (int i = 0; i < Setup::CommandBuffer + 2; i++)
+        RWE.make(Actor::Move).spawn();
+    RWE.make().eachFrame(TIMER_FN {
+        for (int i = 0; i < Setup::CommandBuffer + 2; i++)
+            removed += RWE.remove(EntityId(i));
+        TEST_ASSERT(RWE.remove(0));
+    }).spawn();
+    RWE.runLoop();
+    moving = 0;
+    RWE.each<Actor::Move>([](EntityId) { moving++; });
+    TEST_ASSERT(removed == Setup::CommandBuffer && moving == 2);
+    TEST_ASSERT(RWE.isActiveActor(Setup::CommandBuffer) && !RWE.isActiveActor(Setup::CommandBuffer - 1));
+#endif
+
+    // Collision pairs
+    RWE.reset();
+    colliderCalls = 0;
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }).spawn();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }).spawn();
+    RWE.make().position(5, 1).collider(1, COLLIDER_FN { colliderCalls++; }).spawn();
+    RWE.collisionSystem();
+#if RW_SETUP_COLLISION_BROADPHASE
+    TEST_ASSERT(colliderCalls == 2);
+#else
+    TEST_ASSERT(colliderCalls == 6);
+#endif
+
+    // Collider removing its peer, with RW_SETUP_MAX_COLLIDER the last collider moves into the gap
+    RWE.reset();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN {
+        if (peer == 1)
+            RWE.remove(peer);
+    }).spawn();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { removedPeerCalls++; }).spawn();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN {
+        thirdCalls++;
+        if (receiver != 2)
+            wrongReceiverCalls++;
+    }).spawn();
+    RWE.collisionSystem();
+    TEST_ASSERT(!RWE.isActiveActor(1));
+    TEST_ASSERT(removedPeerCalls == 0 && thirdCalls == 1 && wrongReceiverCalls == 0);
+
+    // Collision layers
+    RWE.reset();
+    colliderCalls = 0;
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }, 1, 1 << 2).spawn();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }, 1, 1 << 2).spawn();
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }, 2, 1 << 1).spawn();
+    RWE.collisionSystem();
+    TEST_ASSERT(colliderCalls == 4);
+    RWE.make().position(1, 0).collider(1, COLLIDER_FN { colliderCalls++; }, 10, 1 << 1).spawn();
+    TEST_ASSERT(RWE.getCollider(3).layer == 2);
+    colliderCalls = 0;
+    RWE.collisionSystem();
+    TEST_ASSERT(colliderCalls == 8);
+
+    // Changed runs
+    RWE.reset();
+    RWE.drawContext.ctx = &updatedRuns;
+    RWE.drawContext.peerUpdateText = +[](void *, int8_t, int8_t, const char *, uint8_t len) {
+        updatedRuns++;
+        updatedCells += len;
+    };
+    RWE.drawContext.invalidate();
+    A::Background().spawn();
+    RWE.make().text("ab").position(3, 1).spawn();
+    RWE.runLoop();
+    TEST_ASSERT(updatedRuns == Setup::ScreenHeight);
+    TEST_ASSERT(updatedCells == Setup::ScreenWidth * Setup::ScreenHeight);
+
+    updatedRuns = 0;
+    updatedCells = 0;
+    RWE.runLoop();
+    TEST_ASSERT(updatedRuns == 0);
+
+    RWE.getPosition(1).x = 4;
+    RWE.runLoop();
+    TEST_ASSERT(updatedRuns == 1);
+    TEST_ASSERT(updatedCells == 3);
+    TEST_ASSERT(RWE.drawContext.isUpdated(3, 1) && RWE.drawContext.isUpdated(5, 1));
+    TEST_ASSERT(!RWE.drawContext.isUpdated(6, 1));
+
+    // ticks without present are diffed once, against the last presented buffer
+    updatedRuns = 0;
+    updatedCells = 0;
+    RWE.getPosition(1).x = 6;
+    RWE.runLoop(false);
+    RWE.getPosition(1).x = 4;
+    RWE.runLoop(false);
+    TEST_ASSERT(updatedRuns == 0);
+    RWE.present();
+    TEST_ASSERT(updatedRuns == 0);
+    RWE.getPosition(1).x = 5;
+    RWE.runLoop(false);
+    RWE.runLoop(false);
+    RWE.present();
+    TEST_ASSERT(updatedRuns == 1 && updatedCells == 3);
+
+#if RW_SETUP_PROFILE
+    // Profile
+    static uint32_t fakeClock;
+    RWE.profile.clock = +[] { return fakeClock++; };
+    RWE.profile.reset();
+    RWE.getPosition(1).x = 3;
+    RWE.runLoop();
+    TEST_ASSERT(RWE.profile.frames == 1);
+    TEST_ASSERT(RWE.profile.frame.ticks[Profile::Input] == 1);
+    TEST_ASSERT(RWE.profile.total.ticks[Profile::Present] == 2);
+    TEST_ASSERT(RWE.profile.frame.peerCalls == RWE.profile.frame.textsDrawn + 1);
+    TEST_ASSERT(RWE.profile.frame.colliderCalls == 0);
+    TEST_ASSERT(RWE.profile.frame.actorsVisited >= 2);
+    RWE.profile.reset();
+    TEST_ASSERT(RWE.profile.frames == 0 && RWE.profile.total.peerCalls == 0);
+#endif
+    RWE.drawContext.ctx = nullptr;
+
+    // Typed shared data
+    static_assert(SharedFlag::Begin == 2 && SharedPtr::Begin == alignof(void *), "shared key layout");
+    RWE.sharedData.get<SharedScore>() = 41;
+    ++RWE.sharedData.get<SharedScore>();
+    RWE.sharedData.get<SharedFlag>() = true;
+    RWE.sharedData.get<SharedPtr>() = &colliderCalls;
+    TEST_ASSERT(RWE.sharedData.get<SharedScore>() == 42 && RWE.sharedData.get<SharedFlag>());
+    TEST_ASSERT(RWE.sharedData.getElement(0).uint16[0] == 42);
+    TEST_ASSERT(static_cast<const SharedData &>(RWE.sharedData).get<SharedPtr>() == &colliderCalls);
+
+    // Fixed timestep
+    Scheduler scheduler(100, 0, 4);
+    scheduler.start(0);
+    TEST_ASSERT(scheduler.ticksDue(0) == 1);
+    TEST_ASSERT(scheduler.presentDue(0));
+    TEST_ASSERT(scheduler.ticksDue(50) == 0);
+    TEST_ASSERT(!scheduler.presentDue(50));
+    TEST_ASSERT(scheduler.timeToNext(50) == 50);
+    TEST_ASSERT(scheduler.ticksDue(350) == 3);
+    TEST_ASSERT(scheduler.stats.maxTickJitter == 250);
+    TEST_ASSERT(scheduler.ticksDue(2000) == 5);
+    TEST_ASSERT(scheduler.stats.skippedTicks == 12);
+    TEST_ASSERT(scheduler.timeToNext(2000) == 100);
+
+    // Engine per config
+    using Big = EngineT<SetupT<40, 25, 100>>;
+    static Big big;
+    TEST_ASSERT(sizeof(big.drawContext.buffer) == 25 * 42);
+    RWE.reset();
+    big.make(Actor::Move).position(30, 20).speed(1, 1).text("big").spawn();
+    TEST_ASSERT(!RWE.isActiveActor(0));
+    big.runLoop();
+    TEST_ASSERT(big.getPosition(0).x == 31 && big.getPosition(0).y == 21);
+    TEST_ASSERT(strncmp(&big.drawContext.buffer[21][31], "big", 3) == 0);
+    TEST_ASSERT(big.getTextLine(0, 24) == nullptr && big.getText(0).count == 1);
+
+    // helpers templated on the engine type work on its singleton
+    auto& bigOne = Big::get();
+    A::Background(bigOne, '.').spawn();
+    TEST_ASSERT(bigOne.getTextLine(0, 24) && strlen(bigOne.getTextLine(0, 24)) == 40);
+    bigOne.make().position(1, 1).hitpoints(3).collider(2, HitPeer<Big>).spawn();
+    bigOne.make().position(1, 1).hitpoints(3).collider(1, HitPeer<Big>).timer(1, TimerRemoveThis<Big>).spawn();
+    bigOne.runLoop();
+    TEST_ASSERT(bigOne.getHitpoints(1).hp == 2 && !bigOne.isActiveActor(2));
+    PageManagerT<Big>::get().setPage(0, +[](Big &page) { page.make(Actor::Move).spawn(); });
+    PageManagerT<Big>::get().switchPage(0);
+    TEST_ASSERT(bigOne.activeEnd() == 1 && RWE.activeEnd() == 0);
+
+    // Sizes of this configuration, rowguelike_tests_features checks the disabled ones
+    // NB: builder values of disabled components are empty
+    TEST_ASSERT(sizeof(_BuilderValue<Engine::Speed, false>) == 1);
+    std::cout << "sizeof(Engine) " << sizeof(Engine) << ", sizeof(Engine::ActorBuilder) " << sizeof(Engine::ActorBuilder)
+              << ", sizeof(Components) " << sizeof(Components) << "\n";
+
     puts("");
     puts("tests completed");
 }